@@ -0,0 +1,371 @@
+#include "pebble_host.h"
+#include "host_private.h"
+#include "camera_controller.h"
+
+// Built in place of the separate objects to reach the digit layers and the
+// atlas format.
+#include "digit_atlas.c"
+#include "digit_renderer.c"
+
+//==============================================================================
+// Renders every digit at every camera waypoint through the live renderer and
+// writes the run-length encoded ink maps digit_atlas.c decodes. Each glyph is
+// drawn once per ink with only that ink white, so the last writer of every
+// pixel shows even on a 1-bit screen. Glyphs that are close to a mirror image
+// of an already stored glyph are kept as that mirror plus the pixels that
+// differ.
+
+#define ATLAS_MAX_PATCH_PIXELS 255
+#define ATLAS_MAX_RUN 32
+
+typedef struct InkMap
+{
+  int width;
+  int height;
+  uint8_t *ink;
+} InkMap;
+
+typedef struct ByteBuffer
+{
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+} ByteBuffer;
+
+typedef struct StoredGlyph
+{
+  const InkMap *map;
+  uint32_t run_offset;
+  uint16_t run_length;
+} StoredGlyph;
+
+static AppSettings s_settings;
+static CameraController s_camera;
+static DigitRenderer s_renderer;
+static InkMap s_glyphs[ATLAS_DIGIT_COUNT * ATLAS_MAX_WAYPOINTS];
+static StoredGlyph s_stored[ATLAS_DIGIT_COUNT * ATLAS_MAX_WAYPOINTS];
+static DigitAtlasEntry s_entries[ATLAS_DIGIT_COUNT * ATLAS_MAX_WAYPOINTS];
+
+static void ink_map_init(InkMap *map, GSize size)
+{
+  map->width = size.w;
+  map->height = size.h;
+  map->ink = calloc((size_t)size.w * size.h, 1);
+}
+
+static void byte_buffer_append(ByteBuffer *buffer, const uint8_t *data, size_t length)
+{
+  if (buffer->length + length > buffer->capacity)
+  {
+    buffer->capacity = (buffer->length + length) * 2;
+    buffer->data = realloc(buffer->data, buffer->capacity);
+  }
+
+  memcpy(buffer->data + buffer->length, data, length);
+  buffer->length += length;
+}
+
+static void byte_buffer_append_byte(ByteBuffer *buffer, uint8_t value)
+{
+  byte_buffer_append(buffer, &value, 1);
+}
+
+//==============================================================================
+// rendering
+
+static void set_ink_colors(DigitAtlasInk ink)
+{
+  s_settings.bg_color = 0x000000;
+  s_settings.face_color = ink == DIGIT_ATLAS_INK_FACE ? 0xFFFFFF : 0x000000;
+  s_settings.face_mix_with_background = false;
+  s_settings.back_line_color = ink == DIGIT_ATLAS_INK_BACK_LINE ? 0xFFFFFF : 0x000000;
+  s_settings.side_line_color = ink == DIGIT_ATLAS_INK_SIDE_LINE ? 0xFFFFFF : 0x000000;
+  s_settings.line_color = ink == DIGIT_ATLAS_INK_FRONT_LINE ? 0xFFFFFF : 0x000000;
+  s_settings.line_mix_with_background = false;
+  s_settings.split_line_colors = true;
+  digit_renderer_mark_all_dirty(&s_renderer);
+}
+
+// Digit slot 0 drawn live at the camera's current pose; a glyph rasterizes the
+// same in every slot.
+static void render_glyph(InkMap *map, int digit)
+{
+  const DigitRendererState *state = s_renderer.state;
+  const GRect rect = glyph_rect(state, &state->digit_data[0]);
+  GBitmap *screen = host_screen_get_bitmap();
+  const GRect screen_bounds = gbitmap_get_bounds(screen);
+
+  digit_renderer_set_digit(&s_renderer, 0, digit, false);
+  for (int ink = DIGIT_ATLAS_INK_FACE; ink < DIGIT_ATLAS_INK_COUNT; ++ink)
+  {
+    set_ink_colors((DigitAtlasInk)ink);
+    host_screen_clear(GColorBlack);
+    host_render_layer(state->digits[0]);
+
+    for (int y = 0; y < map->height; ++y)
+    {
+      const int screen_y = rect.origin.y + y;
+      FramebufferRow row;
+
+      if (screen_y < 0 || screen_y >= screen_bounds.size.h)
+      {
+        continue;
+      }
+
+      row = framebuffer_get_row(screen, screen_y);
+      for (int x = 0; x < map->width; ++x)
+      {
+        const int screen_x = rect.origin.x + x;
+
+        if (screen_x >= row.min_x && screen_x <= row.max_x &&
+          gcolor_equal(framebuffer_row_get_pixel(&row, screen_x), GColorWhite))
+        {
+          map->ink[y * map->width + x] = (uint8_t)ink;
+        }
+      }
+    }
+  }
+}
+
+// Every waypoint the camera rests on, from waypoint 0 until it comes back
+// round; returns how many there are.
+static int render_glyphs(GSize glyph_size)
+{
+  int waypoint_count = 0;
+
+  do
+  {
+    digit_renderer_update_view(&s_renderer, -1);
+    for (int digit = 0; digit < ATLAS_DIGIT_COUNT; ++digit)
+    {
+      InkMap *map = &s_glyphs[digit * ATLAS_MAX_WAYPOINTS + waypoint_count];
+
+      ink_map_init(map, glyph_size);
+      render_glyph(map, digit);
+    }
+    ++waypoint_count;
+
+    camera_controller_start_transition(&s_camera);
+    while (host_animations_active())
+    {
+      host_run_for(33, 33);
+    }
+  } while (camera_controller_get_waypoint_index(&s_camera) != 0 && waypoint_count < ATLAS_MAX_WAYPOINTS);
+
+  return waypoint_count;
+}
+
+//==============================================================================
+// encoding
+
+// Mirrors around the glyph centre the same way emit_span does.
+static void mirror_ink_map(InkMap *out_map, const InkMap *map, uint8_t flags)
+{
+  const int axis_x = map->width / 2 * 2;
+  const int axis_y = map->height / 2 * 2;
+
+  memset(out_map->ink, 0, (size_t)map->width * map->height);
+  for (int y = 0; y < map->height; ++y)
+  {
+    for (int x = 0; x < map->width; ++x)
+    {
+      const int mirrored_x = (flags & ATLAS_FLIP_X) ? axis_x - x : x;
+      const int mirrored_y = (flags & ATLAS_FLIP_Y) ? axis_y - y : y;
+
+      if (mirrored_x >= 0 && mirrored_x < map->width && mirrored_y >= 0 && mirrored_y < map->height)
+      {
+        out_map->ink[mirrored_y * map->width + mirrored_x] = map->ink[y * map->width + x];
+      }
+    }
+  }
+}
+
+// Lines and fills round half a pixel apart, so a mirrored glyph is never
+// exact; the pixels it gets wrong are stored as (x, y, ink) triples.
+static int count_patch_pixels(const InkMap *map, const InkMap *base)
+{
+  int count = 0;
+
+  for (int i = 0; i < map->width * map->height; ++i)
+  {
+    count += map->ink[i] != base->ink[i];
+  }
+
+  return count;
+}
+
+static void encode_patch(ByteBuffer *buffer, const InkMap *map, const InkMap *base)
+{
+  for (int i = 0; i < map->width * map->height; ++i)
+  {
+    if (map->ink[i] != base->ink[i])
+    {
+      byte_buffer_append_byte(buffer, (uint8_t)(i % map->width));
+      byte_buffer_append_byte(buffer, (uint8_t)(i / map->width));
+      byte_buffer_append_byte(buffer, map->ink[i]);
+    }
+  }
+}
+
+// One byte per run: ink in the top 3 bits, length - 1 in the low 5. Runs
+// never cross rows.
+static void encode_runs(ByteBuffer *buffer, const InkMap *map)
+{
+  for (int y = 0; y < map->height; ++y)
+  {
+    const uint8_t *row = &map->ink[y * map->width];
+
+    for (int x = 0; x < map->width;)
+    {
+      int length = 1;
+
+      while (x + length < map->width && length < ATLAS_MAX_RUN && row[x + length] == row[x])
+      {
+        ++length;
+      }
+
+      byte_buffer_append_byte(buffer, (uint8_t)((row[x] << 5) | (length - 1)));
+      x += length;
+    }
+  }
+}
+
+static void write_u16(uint8_t *data, uint16_t value)
+{
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+}
+
+static void write_u32(uint8_t *data, uint32_t value)
+{
+  write_u16(data, (uint16_t)value);
+  write_u16(data + 2, (uint16_t)(value >> 16));
+}
+
+// Index entry: u32 run offset, u16 run length, u8 flip flags, u8 patch pixel
+// count, u32 patch offset. Mirrored entries share the runs of a stored glyph.
+static bool write_atlas(const char *path, GSize glyph_size, int waypoint_count)
+{
+  static const uint8_t FLIPS[] = { ATLAS_FLIP_X, ATLAS_FLIP_Y, ATLAS_FLIP_X | ATLAS_FLIP_Y };
+  const int glyph_count = ATLAS_DIGIT_COUNT * waypoint_count;
+  const uint32_t data_start = ATLAS_HEADER_SIZE + ATLAS_INDEX_ENTRY_SIZE * glyph_count;
+  ByteBuffer data = { 0 };
+  ByteBuffer runs = { 0 };
+  ByteBuffer patch = { 0 };
+  InkMap mirrored;
+  int stored_count = 0;
+  uint8_t header[ATLAS_HEADER_SIZE] = { 'F', 'Z', 'A', 'T', ATLAS_VERSION, ATLAS_DIGIT_COUNT, (uint8_t)waypoint_count };
+  FILE *out;
+
+  ink_map_init(&mirrored, glyph_size);
+  for (int digit = 0; digit < ATLAS_DIGIT_COUNT; ++digit)
+  {
+    for (int waypoint = 0; waypoint < waypoint_count; ++waypoint)
+    {
+      const InkMap *map = &s_glyphs[digit * ATLAS_MAX_WAYPOINTS + waypoint];
+      DigitAtlasEntry *entry = &s_entries[digit * waypoint_count + waypoint];
+      const StoredGlyph *best = NULL;
+      uint8_t best_flags = 0;
+      int best_count = 0;
+
+      runs.length = 0;
+      encode_runs(&runs, map);
+
+      for (int i = 0; i < stored_count; ++i)
+      {
+        for (int f = 0; f < (int)ARRAY_LENGTH(FLIPS); ++f)
+        {
+          int count;
+
+          mirror_ink_map(&mirrored, s_stored[i].map, FLIPS[f]);
+          count = count_patch_pixels(map, &mirrored);
+          if (count <= ATLAS_MAX_PATCH_PIXELS && (best == NULL || count < best_count))
+          {
+            best = &s_stored[i];
+            best_flags = FLIPS[f];
+            best_count = count;
+          }
+        }
+      }
+
+      if (best != NULL && (size_t)best_count * ATLAS_PATCH_PIXEL_SIZE < runs.length)
+      {
+        mirror_ink_map(&mirrored, best->map, best_flags);
+        patch.length = 0;
+        encode_patch(&patch, map, &mirrored);
+        *entry = (DigitAtlasEntry) {
+          .run_offset = best->run_offset,
+          .run_length = best->run_length,
+          .flags = best_flags,
+          .patch_count = (uint8_t)best_count,
+          .patch_offset = best_count > 0 ? data_start + (uint32_t)data.length : 0,
+        };
+        byte_buffer_append(&data, patch.data, patch.length);
+        continue;
+      }
+
+      *entry = (DigitAtlasEntry) { .run_offset = data_start + (uint32_t)data.length, .run_length = (uint16_t)runs.length };
+      s_stored[stored_count++] = (StoredGlyph) { map, entry->run_offset, entry->run_length };
+      byte_buffer_append(&data, runs.data, runs.length);
+    }
+  }
+
+  out = fopen(path, "wb");
+  if (out == NULL)
+  {
+    return false;
+  }
+
+  write_u16(&header[8], (uint16_t)glyph_size.w);
+  write_u16(&header[10], (uint16_t)glyph_size.h);
+  fwrite(header, 1, sizeof(header), out);
+  for (int i = 0; i < glyph_count; ++i)
+  {
+    uint8_t index[ATLAS_INDEX_ENTRY_SIZE];
+
+    write_u32(&index[0], s_entries[i].run_offset);
+    write_u16(&index[4], s_entries[i].run_length);
+    index[6] = s_entries[i].flags;
+    index[7] = s_entries[i].patch_count;
+    write_u32(&index[8], s_entries[i].patch_offset);
+    fwrite(index, 1, sizeof(index), out);
+  }
+  fwrite(data.data, 1, data.length, out);
+  fclose(out);
+
+  printf("%s (%u bytes, %d/%d glyphs stored)\n", path, (unsigned)(data_start + data.length), stored_count,
+    glyph_count);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  // atlas <output>
+  const char *path = argc > 1 ? argv[1] : "digit_atlas.bin";
+  int waypoint_count;
+  GSize glyph_size;
+
+  host_screen_init(GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  app_settings_load(&s_settings);
+
+  if (!camera_controller_init(&s_camera, false, NULL, NULL) ||
+    !digit_renderer_init(&s_renderer, host_screen_get_root_layer(), &s_settings,
+      camera_controller_get_view_matrix(&s_camera), DIGIT_RENDERER_LAYER_PER_DIGIT))
+  {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+
+  glyph_size = s_renderer.state->digit_layer_size;
+  waypoint_count = render_glyphs(glyph_size);
+  if (!write_atlas(path, glyph_size, waypoint_count))
+  {
+    fprintf(stderr, "failed to write %s\n", path);
+    return 1;
+  }
+
+  digit_renderer_deinit(&s_renderer);
+  camera_controller_deinit(&s_camera);
+  host_screen_deinit();
+  return 0;
+}
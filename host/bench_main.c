@@ -0,0 +1,858 @@
+#include <time.h>
+#include "pebble_host.h"
+#include "host_private.h"
+
+// Built in place of the separate objects so the static stages can be timed
+// directly.
+#include "camera_controller.c"
+#include "digit_renderer.c"
+#include "framebuffer.h"
+
+//==============================================================================
+// Per-stage timing of the digit render pipeline over every digit and a sweep
+// of camera ratios between each pair of EYE_WAYPOINTS. Prints a summary to
+// stderr and JSON to the path given on the command line (stdout by default).
+
+#define RATIO_STEPS 16
+#define SWEEP_SIZE (WAYPOINT_COUNT * RATIO_STEPS)
+#define REPEATS 40
+#define STEADY_MINUTES 12
+#define STEADY_FRAME_MS 33
+// the bench fails when the app's arena use comes closer than this to ARENA_SIZE_BYTES
+#define ARENA_MIN_HEADROOM_BYTES 256
+
+#ifndef HOST_PLATFORM_NAME
+#define HOST_PLATFORM_NAME "unknown"
+#endif
+
+typedef enum BenchStage
+{
+  STAGE_LOOK_AT,
+  STAGE_KEYFRAME_VIEW,
+  STAGE_ORBIT_VIEW,
+  STAGE_MULTIPLY_VEC3,
+  STAGE_UPDATE_PROC,
+  STAGE_CACHED_UPDATE_PROC,
+  STAGE_ATLAS_LOAD,
+  STAGE_POLY_FILL,
+  STAGE_SILHOUETTE_FILL,
+  STAGE_FRAMEBUFFER_FILL,
+  STAGE_BACK_LINES,
+  STAGE_SIDE_LINES,
+  STAGE_FRONT_LINES,
+  STAGE_FRAMEBUFFER_LINES,
+  STAGE_COUNT
+} BenchStage;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+  "mat4_look_at_rh",
+  "set_view_from_keyframes",
+  "set_view_from_angle",
+  "mat4_multiply_vec3",
+  "poly_layer_update_proc",
+  "poly_layer_update_proc_cached",
+  "glyph_cache_load_atlas",
+  "draw_poly_fill",
+  "draw_silhouette_fill",
+  "draw_silhouette_fill_framebuffer",
+  "draw_back_lines",
+  "draw_side_lines",
+  "draw_front_lines",
+  "draw_lines_framebuffer",
+};
+
+typedef struct StageResult
+{
+  double total_ns;
+  uint32_t calls;
+} StageResult;
+
+typedef struct DigitResult
+{
+  StageResult stages[STAGE_COUNT];
+  double transforms_per_frame;
+  double draw_calls_per_frame;
+  double fill_calls_per_frame;
+  double line_calls_per_frame;
+  double pixels_per_frame;
+  double layer_area_per_frame;
+  // cached (atlas or captured) glyph vs live draw of the same digit at each waypoint
+  uint32_t cache_mismatch_pixels;
+  // framebuffer spans vs gpath_draw_filled faces over the sweep
+  uint32_t fill_mismatch_pixels;
+  // framebuffer lines vs graphics_draw_line over the sweep
+  uint32_t line_mismatch_pixels;
+} DigitResult;
+
+// Whole moving frames through host_render, per DigitRendererLayout.
+typedef struct LayoutResult
+{
+  double ns_per_frame;
+  double layer_updates_per_frame;
+  double fill_color_changes_per_frame;
+  double stroke_color_changes_per_frame;
+  double draw_calls_per_frame;
+} LayoutResult;
+
+// Minute transitions through a camera wired to a renderer, as in the app.
+typedef struct SteadyStateResult
+{
+  uint32_t minutes;
+  // first frame after init, at rest: bitmap blits and framebuffer captures
+  uint32_t first_frame_bitmaps;
+  uint32_t first_frame_captures;
+  bool has_atlas;
+  // heap allocations after the first minute: one animation per transition, as
+  // SDK 3 frees an animation after its stopped handler
+  uint32_t heap_allocations;
+  // of those, still allocated at the end; anything but 0 is a leak
+  uint32_t heap_retained;
+  size_t arena_bytes;
+} SteadyStateResult;
+
+static const char *LAYOUT_NAMES[] = {
+  "per_digit",
+  "single_layer",
+};
+
+static Mat4 s_view_matrix;
+static Vec3 s_sweep_eyes[SWEEP_SIZE];
+static AppSettings s_settings;
+static CameraController s_camera;
+static DigitRenderer s_renderer;
+static DigitResult s_digit_results[10];
+static StageResult s_math_results[STAGE_UPDATE_PROC];
+static LayoutResult s_layout_results[ARRAY_LENGTH(LAYOUT_NAMES)];
+static SteadyStateResult s_steady_results[ARRAY_LENGTH(LAYOUT_NAMES)];
+static CameraController s_steady_camera;
+static DigitRenderer s_steady_renderer;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void init_sweep(void)
+{
+  for (int i = 0; i < SWEEP_SIZE; ++i)
+  {
+    const Vec3 *from = &EYE_WAYPOINTS[i / RATIO_STEPS];
+    const Vec3 *to = &EYE_WAYPOINTS[(i / RATIO_STEPS + 1) % WAYPOINT_COUNT];
+    Scalar ratio = scalar_from_fraction(i % RATIO_STEPS, RATIO_STEPS);
+
+    s_sweep_eyes[i] = Vec3(
+      scalar_mul(from->x, SCALAR_ONE - ratio) + scalar_mul(to->x, ratio),
+      scalar_mul(from->y, SCALAR_ONE - ratio) + scalar_mul(to->y, ratio),
+      SCALAR_ONE);
+  }
+}
+
+static void set_renderer_sweep_view(DigitRenderer *renderer, int index, int waypoint_index)
+{
+  const Vec3 at = Vec3(0, 0, 0);
+  const Vec3 up = Vec3(0, SCALAR_ONE, 0);
+
+  mat4_look_at_rh(&s_view_matrix, &s_sweep_eyes[index], &at, &up);
+  digit_renderer_update_view(renderer, waypoint_index);
+}
+
+static void set_sweep_view(int index, int waypoint_index)
+{
+  set_renderer_sweep_view(&s_renderer, index, waypoint_index);
+}
+
+static uint32_t draw_calls(const HostStats *stats)
+{
+  return stats->fill_calls + stats->line_calls + stats->rect_calls + stats->bitmap_calls;
+}
+
+// What project_model_points transforms for the layer's view: the front points
+// alone on the affine path. The renderer only counts with the profiler.
+static int projection_transforms(const PolyLayerData *data)
+{
+  return data->affine ? DIGIT_MESH_POINT_COUNT : DIGIT_MESH_POINT_COUNT * 2;
+}
+
+//==============================================================================
+// stages
+
+static void bench_math(void)
+{
+  const Vec3 at = Vec3(0, 0, 0);
+  const Vec3 up = Vec3(0, SCALAR_ONE, 0);
+  const DigitRendererState *state = s_renderer.state;
+  volatile Scalar sink = 0;
+  double start;
+
+  start = now_ns();
+  for (int r = 0; r < REPEATS * 10; ++r)
+  {
+    for (int i = 0; i < SWEEP_SIZE; ++i)
+    {
+      mat4_look_at_rh(&s_view_matrix, &s_sweep_eyes[i], &at, &up);
+      sink += s_view_matrix.m[_03];
+    }
+  }
+  s_math_results[STAGE_LOOK_AT].total_ns = now_ns() - start;
+  s_math_results[STAGE_LOOK_AT].calls = REPEATS * 10 * SWEEP_SIZE;
+
+  start = now_ns();
+  for (int r = 0; r < REPEATS * 10; ++r)
+  {
+    for (int i = 0; i < SWEEP_SIZE; ++i)
+    {
+      set_view_from_keyframes(s_camera.state, i / RATIO_STEPS,
+        (AnimationProgress)(i % RATIO_STEPS) * ANIMATION_NORMALIZED_MAX / RATIO_STEPS);
+      sink += s_camera.state->view_matrix.m[_03];
+    }
+  }
+  s_math_results[STAGE_KEYFRAME_VIEW].total_ns = now_ns() - start;
+  s_math_results[STAGE_KEYFRAME_VIEW].calls = REPEATS * 10 * SWEEP_SIZE;
+
+  start = now_ns();
+  for (int r = 0; r < REPEATS * 10; ++r)
+  {
+    for (int i = 0; i < SWEEP_SIZE; ++i)
+    {
+      set_view_from_angle(s_camera.state, waypoint_angle(0) - i * ORBIT_STEP_ANGLE / RATIO_STEPS);
+      sink += s_camera.state->view_matrix.m[_03];
+    }
+  }
+  s_math_results[STAGE_ORBIT_VIEW].total_ns = now_ns() - start;
+  s_math_results[STAGE_ORBIT_VIEW].calls = REPEATS * 10 * SWEEP_SIZE;
+
+  for (int i = 0; i < SWEEP_SIZE; ++i)
+  {
+    const PolyLayerData *data;
+    Vec3 out;
+
+    set_sweep_view(i, -1);
+    data = &state->digit_data[0];
+    start = now_ns();
+    for (int r = 0; r < REPEATS; ++r)
+    {
+      for (int p = 0; p < DIGIT_MESH_POINT_COUNT * 2; ++p)
+      {
+        mat4_multiply_vec3(&out, &data->model_view, &state->model_points[p]);
+        sink += out.x;
+      }
+    }
+    s_math_results[STAGE_MULTIPLY_VEC3].total_ns += now_ns() - start;
+    s_math_results[STAGE_MULTIPLY_VEC3].calls += REPEATS * DIGIT_MESH_POINT_COUNT * 2;
+  }
+}
+
+// The layer's fill and line passes written into the captured framebuffer, in white.
+static void begin_framebuffer_target(DrawTarget *target, Layer *layer, GContext *ctx, const PolyLayerData *data)
+{
+  const GRect frame = layer_get_frame(layer);
+  const GRect bounds = layer_get_bounds(layer);
+
+  draw_target_begin(target, ctx, data->renderer->state,
+    GPoint(frame.origin.x + bounds.origin.x, frame.origin.y + bounds.origin.y), frame);
+  draw_target_set_fill_color(target, GColorWhite);
+  draw_target_set_stroke_color(target, GColorWhite);
+}
+
+static void draw_line_passes(const DrawTarget *target, const DigitMesh *mesh, const GPoint *screen_poss)
+{
+  draw_back_lines(target, mesh, screen_poss);
+  draw_side_lines(target, mesh, screen_poss);
+  draw_front_lines(target, mesh, screen_poss);
+}
+
+static void time_stage(StageResult *result, BenchStage stage, Layer *layer, GContext *ctx,
+  const PolyLayerData *data, const GPoint *screen_poss)
+{
+  const DigitMesh *mesh = data->mesh;
+  const DrawTarget context_target = { .ctx = ctx, .framebuffer = NULL };
+  DrawTarget target;
+  double start = now_ns();
+
+  for (int r = 0; r < REPEATS; ++r)
+  {
+    switch (stage)
+    {
+      case STAGE_UPDATE_PROC:
+        poly_layer_update_proc(layer, ctx);
+        break;
+      case STAGE_POLY_FILL:
+        draw_poly_fill(ctx, mesh, screen_poss, data->eye_quadrant);
+        break;
+      case STAGE_SILHOUETTE_FILL:
+        draw_silhouette_fill(&context_target, mesh, screen_poss, data->eye_quadrant);
+        break;
+      case STAGE_FRAMEBUFFER_FILL:
+        begin_framebuffer_target(&target, layer, ctx, data);
+        draw_silhouette_fill(&target, mesh, screen_poss, data->eye_quadrant);
+        draw_target_end(&target);
+        break;
+      case STAGE_BACK_LINES:
+        draw_back_lines(&context_target, mesh, screen_poss);
+        break;
+      case STAGE_SIDE_LINES:
+        draw_side_lines(&context_target, mesh, screen_poss);
+        break;
+      case STAGE_FRONT_LINES:
+        draw_front_lines(&context_target, mesh, screen_poss);
+        break;
+#ifdef FRAMEBUFFER_LINES
+      case STAGE_FRAMEBUFFER_LINES:
+        begin_framebuffer_target(&target, layer, ctx, data);
+        draw_line_passes(&target, mesh, screen_poss);
+        draw_target_end(&target);
+        break;
+#endif
+      default:
+        break;
+    }
+  }
+
+  result->total_ns += now_ns() - start;
+  result->calls += REPEATS;
+}
+
+static void snapshot_screen(uint8_t *out_pixels)
+{
+  const GBitmap *screen = host_screen_get_bitmap();
+
+  memcpy(out_pixels, gbitmap_get_data(screen),
+    (size_t)gbitmap_get_bytes_per_row(screen) * gbitmap_get_bounds(screen).size.h);
+}
+
+static uint32_t count_mismatches(const uint8_t *pixels)
+{
+  GBitmap *screen = host_screen_get_bitmap();
+  const GRect bounds = gbitmap_get_bounds(screen);
+  const uint16_t bytes_per_row = gbitmap_get_bytes_per_row(screen);
+  uint32_t mismatches = 0;
+
+  for (int y = 0; y < bounds.size.h; ++y)
+  {
+    const FramebufferRow row = framebuffer_get_row(screen, y);
+    const FramebufferRow expected = { (uint8_t *)pixels + y * bytes_per_row, row.min_x, row.max_x, row.one_bit };
+
+    for (int x = row.min_x; x <= row.max_x; ++x)
+    {
+      mismatches += !gcolor_equal(framebuffer_row_get_pixel(&row, x), framebuffer_row_get_pixel(&expected, x));
+    }
+  }
+
+  return mismatches;
+}
+
+// The graphics context draw, then the same pass written into the captured
+// framebuffer, each on a cleared screen in white: faces through
+// gpath_draw_filled vs the framebuffer spans, or the three line passes.
+static uint32_t framebuffer_mismatches(uint8_t *pixels, Layer *layer, GContext *ctx, const PolyLayerData *data,
+  const GPoint *screen_poss, bool lines)
+{
+  const DrawTarget context_target = { .ctx = ctx, .framebuffer = NULL };
+  DrawTarget target;
+
+  host_screen_clear(GColorBlack);
+  graphics_context_set_fill_color(ctx, GColorWhite);
+  graphics_context_set_stroke_color(ctx, GColorWhite);
+  if (lines)
+  {
+    draw_line_passes(&context_target, data->mesh, screen_poss);
+  }
+  else
+  {
+    draw_poly_fill(ctx, data->mesh, screen_poss, data->eye_quadrant);
+  }
+  snapshot_screen(pixels);
+
+  host_screen_clear(GColorBlack);
+  begin_framebuffer_target(&target, layer, ctx, data);
+  if (lines)
+  {
+    draw_line_passes(&target, data->mesh, screen_poss);
+  }
+  else
+  {
+    draw_silhouette_fill(&target, data->mesh, screen_poss, data->eye_quadrant);
+  }
+  draw_target_end(&target);
+
+  return count_mismatches(pixels);
+}
+
+// HostStats only sees the graphics context, which DIGIT_FILL_FRAMEBUFFER
+// writes around, so the counted passes draw the faces and lines through it.
+static void counted_update_proc(DigitRendererState *state, Layer *layer, GContext *ctx)
+{
+  const DigitFillMode fill_mode = state->fill_mode;
+
+  state->fill_mode = DIGIT_FILL_FACES;
+  poly_layer_update_proc(layer, ctx);
+  state->fill_mode = fill_mode;
+}
+
+static void counted_render(DigitRendererState *state)
+{
+  const DigitFillMode fill_mode = state->fill_mode;
+
+  state->fill_mode = DIGIT_FILL_FACES;
+  host_render();
+  state->fill_mode = fill_mode;
+}
+
+static void bench_digit(int digit)
+{
+  DigitRendererState *state = s_renderer.state;
+  DigitResult *result = &s_digit_results[digit];
+  Layer *layer = state->digits[0];
+  PolyLayerData *data = &state->digit_data[0];
+  GPoint screen_poss[DIGIT_MESH_POINT_COUNT * 2];
+  const GBitmap *screen = host_screen_get_bitmap();
+  uint8_t *pixels = malloc((size_t)gbitmap_get_bytes_per_row(screen) * gbitmap_get_bounds(screen).size.h);
+
+  digit_renderer_set_digit(&s_renderer, 0, digit, false);
+
+  for (int i = 0; i < SWEEP_SIZE; ++i)
+  {
+    GRect frame;
+    GRect bounds;
+    GContext *ctx;
+
+    // One counted pass per sweep sample, then the timed repeats.
+    set_sweep_view(i, -1);
+    frame = layer_get_frame(layer);
+    bounds = layer_get_bounds(layer);
+    ctx = host_context_begin(frame, GPoint(frame.origin.x + bounds.origin.x, frame.origin.y + bounds.origin.y));
+
+    host_stats_reset();
+    counted_update_proc(state, layer, ctx);
+    result->transforms_per_frame += projection_transforms(data);
+    result->layer_area_per_frame += frame.size.w * frame.size.h;
+    result->draw_calls_per_frame += draw_calls(host_stats_get());
+    result->fill_calls_per_frame += host_stats_get()->fill_calls;
+    result->line_calls_per_frame += host_stats_get()->line_calls;
+    result->pixels_per_frame += host_stats_get()->pixels_written;
+
+    project_model_points(screen_poss, data);
+    result->fill_mismatch_pixels += framebuffer_mismatches(pixels, layer, ctx, data, screen_poss, false);
+#ifdef FRAMEBUFFER_LINES
+    result->line_mismatch_pixels += framebuffer_mismatches(pixels, layer, ctx, data, screen_poss, true);
+#endif
+    for (int stage = STAGE_UPDATE_PROC; stage < STAGE_COUNT; ++stage)
+    {
+#ifndef FRAMEBUFFER_LINES
+      if (stage == STAGE_FRAMEBUFFER_LINES)
+      {
+        continue;
+      }
+#endif
+      if (stage != STAGE_CACHED_UPDATE_PROC && stage != STAGE_ATLAS_LOAD)
+      {
+        time_stage(&result->stages[stage], stage, layer, ctx, data, screen_poss);
+      }
+    }
+  }
+
+  result->transforms_per_frame /= SWEEP_SIZE;
+  result->draw_calls_per_frame /= SWEEP_SIZE;
+  result->fill_calls_per_frame /= SWEEP_SIZE;
+  result->line_calls_per_frame /= SWEEP_SIZE;
+  result->pixels_per_frame /= SWEEP_SIZE;
+  result->layer_area_per_frame /= SWEEP_SIZE;
+  free(pixels);
+}
+
+// Live draw, then a miss (atlas decode, or capture without an atlas), timed
+// hits and timed atlas loads at every waypoint.
+static void bench_glyph_cache(int digit)
+{
+  DigitRendererState *state = s_renderer.state;
+  DigitResult *result = &s_digit_results[digit];
+  Layer *layer = state->digits[0];
+  const GBitmap *screen = host_screen_get_bitmap();
+  const GColor background = app_settings_get_background_color(&s_settings);
+  uint8_t *live_pixels = malloc((size_t)gbitmap_get_bytes_per_row(screen) * gbitmap_get_bounds(screen).size.h);
+
+  for (int waypoint = 0; waypoint < WAYPOINT_COUNT; ++waypoint)
+  {
+    GRect frame;
+    double start;
+
+    set_sweep_view(waypoint * RATIO_STEPS, -1);
+    host_screen_clear(background);
+    host_render_layer(layer);
+    snapshot_screen(live_pixels);
+
+    glyph_cache_flush(&state->glyph_cache);
+    set_sweep_view(waypoint * RATIO_STEPS, waypoint);
+    host_screen_clear(background);
+    host_render_layer(layer);
+    host_screen_clear(background);
+    host_render_layer(layer);
+    result->cache_mismatch_pixels += count_mismatches(live_pixels);
+
+    frame = layer_get_frame(layer);
+    start = now_ns();
+    for (int r = 0; r < REPEATS; ++r)
+    {
+      poly_layer_update_proc(layer, host_context_begin(frame, frame.origin));
+    }
+    result->stages[STAGE_CACHED_UPDATE_PROC].total_ns += now_ns() - start;
+    result->stages[STAGE_CACHED_UPDATE_PROC].calls += REPEATS;
+
+    if (state->atlas.state != NULL)
+    {
+      AtlasGlyphLoad load = { .state = state, .digit = digit };
+
+      start = now_ns();
+      for (int r = 0; r < REPEATS; ++r)
+      {
+        glyph_cache_flush(&state->glyph_cache);
+        glyph_cache_load(&state->glyph_cache, digit, waypoint, load_atlas_glyph, &load);
+      }
+      result->stages[STAGE_ATLAS_LOAD].total_ns += now_ns() - start;
+      result->stages[STAGE_ATLAS_LOAD].calls += REPEATS;
+    }
+  }
+
+  free(live_pixels);
+}
+
+// "12:34" over the whole sweep with a fresh renderer per layout.
+static void bench_layouts(void)
+{
+  static const int DIGITS[DIGIT_RENDERER_DIGIT_COUNT] = { 1, 2, 3, 4 };
+
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    LayoutResult *result = &s_layout_results[layout];
+    DigitRenderer renderer;
+    double total_ns = 0;
+
+    if (!digit_renderer_init(&renderer, host_screen_get_root_layer(), &s_settings, &s_view_matrix,
+      (DigitRendererLayout)layout))
+    {
+      continue;
+    }
+
+    for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+    {
+      digit_renderer_set_digit(&renderer, i, DIGITS[i], false);
+    }
+
+    for (int i = 0; i < SWEEP_SIZE; ++i)
+    {
+      const HostStats *stats = host_stats_get();
+      double start;
+
+      set_renderer_sweep_view(&renderer, i, -1);
+      host_stats_reset();
+      counted_render(renderer.state);
+      result->layer_updates_per_frame += stats->layer_updates;
+      result->fill_color_changes_per_frame += stats->fill_color_changes;
+      result->stroke_color_changes_per_frame += stats->stroke_color_changes;
+      result->draw_calls_per_frame += draw_calls(stats);
+
+      start = now_ns();
+      for (int r = 0; r < REPEATS; ++r)
+      {
+        host_render();
+      }
+      total_ns += now_ns() - start;
+    }
+
+    result->ns_per_frame = total_ns / (SWEEP_SIZE * REPEATS);
+    result->layer_updates_per_frame /= SWEEP_SIZE;
+    result->fill_color_changes_per_frame /= SWEEP_SIZE;
+    result->stroke_color_changes_per_frame /= SWEEP_SIZE;
+    result->draw_calls_per_frame /= SWEEP_SIZE;
+    digit_renderer_deinit(&renderer);
+  }
+}
+
+static void steady_state_invalidate(void *context)
+{
+  digit_renderer_update_view(&s_steady_renderer, camera_controller_get_waypoint_index(&s_steady_camera));
+}
+
+// Shows "12:34" plus minute and runs its camera transition to rest.
+static void run_steady_minute(int minute)
+{
+  int total = (12 * 60 + 34 + minute) % (24 * 60);
+  const int digits[DIGIT_RENDERER_DIGIT_COUNT] = {
+    total / 600, total / 60 % 10, total % 60 / 10, total % 10,
+  };
+
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  {
+    digit_renderer_set_digit(&s_steady_renderer, i, digits[i], false);
+  }
+  camera_controller_start_transition(&s_steady_camera);
+  do
+  {
+    host_run_for(STEADY_FRAME_MS, STEADY_FRAME_MS);
+  } while (host_animations_active());
+}
+
+// After the first minute, a transition's animation should be the only heap
+// allocation, and the system should have freed it when it stopped.
+static void bench_steady_state(void)
+{
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    SteadyStateResult *result = &s_steady_results[layout];
+
+    if (!camera_controller_init(&s_steady_camera, false, steady_state_invalidate, NULL))
+    {
+      continue;
+    }
+    if (!digit_renderer_init(&s_steady_renderer, host_screen_get_root_layer(), &s_settings,
+      camera_controller_get_view_matrix(&s_steady_camera), (DigitRendererLayout)layout))
+    {
+      camera_controller_deinit(&s_steady_camera);
+      continue;
+    }
+    steady_state_invalidate(NULL);
+    for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+    {
+      digit_renderer_set_digit(&s_steady_renderer, i, i + 1, false);
+    }
+    host_stats_reset();
+    host_render();
+    result->first_frame_bitmaps = host_stats_get()->bitmap_calls;
+    result->first_frame_captures = host_stats_get()->framebuffer_captures;
+    result->has_atlas = s_steady_renderer.state->atlas.state != NULL;
+
+    run_steady_minute(0);
+    host_stats_reset();
+    for (int minute = 1; minute <= STEADY_MINUTES; ++minute)
+    {
+      run_steady_minute(minute);
+    }
+    result->minutes = STEADY_MINUTES;
+    result->heap_allocations = host_stats_get()->heap_allocations;
+    result->heap_retained = host_stats_get()->heap_allocations - host_stats_get()->heap_frees;
+    result->arena_bytes = arena_bytes_used();
+
+    digit_renderer_deinit(&s_steady_renderer);
+    camera_controller_deinit(&s_steady_camera);
+  }
+}
+
+//==============================================================================
+// output
+
+static double ns_per_call(const StageResult *result)
+{
+  return result->calls > 0 ? result->total_ns / result->calls : 0;
+}
+
+static void write_json(FILE *out)
+{
+  fprintf(out, "{\n  \"platform\": \"%s\",\n", HOST_PLATFORM_NAME);
+#ifdef MATH_FIXED_POINT
+  fprintf(out, "  \"backend\": \"fixed\",\n");
+#else
+  fprintf(out, "  \"backend\": \"float\",\n");
+#endif
+  fprintf(out, "  \"sweep\": { \"waypoints\": %d, \"ratio_steps\": %d, \"repeats\": %d },\n",
+    WAYPOINT_COUNT, RATIO_STEPS, REPEATS);
+  fprintf(out, "  \"math\": {\n");
+  for (int stage = 0; stage < STAGE_UPDATE_PROC; ++stage)
+  {
+    fprintf(out, "    \"%s\": { \"ns_per_call\": %.1f }%s\n", STAGE_NAMES[stage],
+      ns_per_call(&s_math_results[stage]), stage + 1 < STAGE_UPDATE_PROC ? "," : "");
+  }
+  fprintf(out, "  },\n  \"digits\": [\n");
+
+  for (int digit = 0; digit < 10; ++digit)
+  {
+    const DigitResult *result = &s_digit_results[digit];
+
+    fprintf(out, "    {\n      \"digit\": %d,\n", digit);
+    fprintf(out, "      \"transforms_per_frame\": %.1f,\n", result->transforms_per_frame);
+    fprintf(out, "      \"draw_calls_per_frame\": %.1f,\n", result->draw_calls_per_frame);
+    fprintf(out, "      \"fill_calls_per_frame\": %.1f,\n", result->fill_calls_per_frame);
+    fprintf(out, "      \"line_calls_per_frame\": %.1f,\n", result->line_calls_per_frame);
+    fprintf(out, "      \"pixels_per_frame\": %.1f,\n", result->pixels_per_frame);
+    fprintf(out, "      \"layer_area_per_frame\": %.1f,\n", result->layer_area_per_frame);
+    fprintf(out, "      \"cache_mismatch_pixels\": %u,\n", (unsigned)result->cache_mismatch_pixels);
+    fprintf(out, "      \"fill_mismatch_pixels\": %u,\n", (unsigned)result->fill_mismatch_pixels);
+    fprintf(out, "      \"line_mismatch_pixels\": %u,\n", (unsigned)result->line_mismatch_pixels);
+    fprintf(out, "      \"ns_per_call\": {");
+    for (int stage = STAGE_UPDATE_PROC; stage < STAGE_COUNT; ++stage)
+    {
+      fprintf(out, "%s \"%s\": %.1f", stage == STAGE_UPDATE_PROC ? "" : ",", STAGE_NAMES[stage],
+        ns_per_call(&result->stages[stage]));
+    }
+    fprintf(out, " }\n    }%s\n", digit < 9 ? "," : "");
+  }
+
+  fprintf(out, "  ],\n  \"layouts\": {\n");
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    const LayoutResult *result = &s_layout_results[layout];
+
+    fprintf(out, "    \"%s\": { \"ns_per_frame\": %.1f, \"layer_updates_per_frame\": %.1f, "
+      "\"fill_color_changes_per_frame\": %.1f, \"stroke_color_changes_per_frame\": %.1f, "
+      "\"draw_calls_per_frame\": %.1f }%s\n", LAYOUT_NAMES[layout], result->ns_per_frame,
+      result->layer_updates_per_frame, result->fill_color_changes_per_frame,
+      result->stroke_color_changes_per_frame, result->draw_calls_per_frame,
+      layout + 1 < (int)ARRAY_LENGTH(LAYOUT_NAMES) ? "," : "");
+  }
+  fprintf(out, "  },\n  \"steady_state\": {\n");
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    const SteadyStateResult *result = &s_steady_results[layout];
+
+    fprintf(out, "    \"%s\": { \"first_frame_bitmaps\": %u, \"first_frame_captures\": %u, \"minutes\": %u, "
+      "\"heap_allocations\": %u, \"heap_retained\": %u, \"arena_bytes\": %u, \"arena_headroom\": %u }%s\n",
+      LAYOUT_NAMES[layout], (unsigned)result->first_frame_bitmaps, (unsigned)result->first_frame_captures,
+      (unsigned)result->minutes, (unsigned)result->heap_allocations, (unsigned)result->heap_retained, (unsigned)result->arena_bytes,
+      (unsigned)(ARENA_SIZE_BYTES - result->arena_bytes), layout + 1 < (int)ARRAY_LENGTH(LAYOUT_NAMES) ? "," : "");
+  }
+  fprintf(out, "  }\n}\n");
+}
+
+static void print_summary(void)
+{
+  for (int stage = 0; stage < STAGE_UPDATE_PROC; ++stage)
+  {
+    fprintf(stderr, "%-24s %10.1f ns\n", STAGE_NAMES[stage], ns_per_call(&s_math_results[stage]));
+  }
+  fprintf(stderr, "digit  update_proc  cached  atlas  poly_fill  silhouette  framebuffer  back  side  front  fb_lines  transforms  draw_calls  pixels  area  cache_diff  fill_diff  line_diff\n");
+  for (int digit = 0; digit < 10; ++digit)
+  {
+    const DigitResult *result = &s_digit_results[digit];
+
+    fprintf(stderr, "%5d %12.0f %7.0f %6.0f %10.0f %11.0f %12.0f %5.0f %5.0f %6.0f %9.0f %11.1f %11.1f %7.0f %5.0f %11u %10u %10u\n",
+      digit,
+      ns_per_call(&result->stages[STAGE_UPDATE_PROC]), ns_per_call(&result->stages[STAGE_CACHED_UPDATE_PROC]),
+      ns_per_call(&result->stages[STAGE_ATLAS_LOAD]), ns_per_call(&result->stages[STAGE_POLY_FILL]),
+      ns_per_call(&result->stages[STAGE_SILHOUETTE_FILL]), ns_per_call(&result->stages[STAGE_FRAMEBUFFER_FILL]),
+      ns_per_call(&result->stages[STAGE_BACK_LINES]),
+      ns_per_call(&result->stages[STAGE_SIDE_LINES]), ns_per_call(&result->stages[STAGE_FRONT_LINES]),
+      ns_per_call(&result->stages[STAGE_FRAMEBUFFER_LINES]),
+      result->transforms_per_frame, result->draw_calls_per_frame, result->pixels_per_frame,
+      result->layer_area_per_frame, (unsigned)result->cache_mismatch_pixels,
+      (unsigned)result->fill_mismatch_pixels, (unsigned)result->line_mismatch_pixels);
+  }
+
+  fprintf(stderr, "layout        frame_ns  layer_updates  fill_colors  stroke_colors  draw_calls\n");
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    const LayoutResult *result = &s_layout_results[layout];
+
+    fprintf(stderr, "%-12s %9.0f %14.1f %12.1f %14.1f %11.1f\n", LAYOUT_NAMES[layout], result->ns_per_frame,
+      result->layer_updates_per_frame, result->fill_color_changes_per_frame,
+      result->stroke_color_changes_per_frame, result->draw_calls_per_frame);
+  }
+
+  fprintf(stderr, "steady_state  first_bitmaps  first_captures  minutes  heap_allocations  heap_retained  arena_bytes  arena_headroom\n");
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    const SteadyStateResult *result = &s_steady_results[layout];
+
+    fprintf(stderr, "%-12s %14u %15u %8u %17u %14u %12u %15u\n", LAYOUT_NAMES[layout],
+      (unsigned)result->first_frame_bitmaps, (unsigned)result->first_frame_captures, (unsigned)result->minutes,
+      (unsigned)result->heap_allocations, (unsigned)result->heap_retained, (unsigned)result->arena_bytes,
+      (unsigned)(ARENA_SIZE_BYTES - result->arena_bytes));
+  }
+}
+
+// Leaks and a full arena only show up on the watch as a failed init hours or
+// releases later, so they fail the bench instead.
+static bool check_steady_state(void)
+{
+  bool ok = true;
+
+  for (int layout = 0; layout < (int)ARRAY_LENGTH(LAYOUT_NAMES); ++layout)
+  {
+    const SteadyStateResult *result = &s_steady_results[layout];
+
+    if (result->minutes == 0)
+    {
+      fprintf(stderr, "FAIL: %s did not initialize\n", LAYOUT_NAMES[layout]);
+      ok = false;
+      continue;
+    }
+    if (result->has_atlas && (result->first_frame_bitmaps == 0 || result->first_frame_captures != 0))
+    {
+      fprintf(stderr, "FAIL: %s drew its first frame live instead of from the atlas\n", LAYOUT_NAMES[layout]);
+      ok = false;
+    }
+    if (result->heap_allocations > result->minutes)
+    {
+      fprintf(stderr, "FAIL: %s made %u heap allocations in %u transitions\n", LAYOUT_NAMES[layout],
+        (unsigned)result->heap_allocations, (unsigned)result->minutes);
+      ok = false;
+    }
+    if (result->heap_retained != 0)
+    {
+      fprintf(stderr, "FAIL: %s retained %u heap blocks\n", LAYOUT_NAMES[layout], (unsigned)result->heap_retained);
+      ok = false;
+    }
+    if (ARENA_SIZE_BYTES - result->arena_bytes < ARENA_MIN_HEADROOM_BYTES)
+    {
+      fprintf(stderr, "FAIL: %s leaves %u arena bytes, under %u\n", LAYOUT_NAMES[layout],
+        (unsigned)(ARENA_SIZE_BYTES - result->arena_bytes), ARENA_MIN_HEADROOM_BYTES);
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  FILE *out = stdout;
+
+  host_screen_init(GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  app_settings_load(&s_settings);
+  if (argc > 2 && argv[2][0] != '\0' && !host_resource_load(RESOURCE_ID_DIGIT_ATLAS, argv[2]))
+  {
+    fprintf(stderr, "failed to load %s\n", argv[2]);
+    return 1;
+  }
+  init_sweep();
+  set_sweep_view(0, -1);
+
+  if (!camera_controller_init(&s_camera, false, NULL, NULL) ||
+    !digit_renderer_init(&s_renderer, host_screen_get_root_layer(), &s_settings, &s_view_matrix,
+      DIGIT_RENDERER_LAYER_PER_DIGIT))
+  {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+
+  bench_math();
+  for (int digit = 0; digit < 10; ++digit)
+  {
+    bench_digit(digit);
+    bench_glyph_cache(digit);
+  }
+  digit_renderer_deinit(&s_renderer);
+  camera_controller_deinit(&s_camera);
+  bench_layouts();
+  bench_steady_state();
+
+  print_summary();
+
+  if (argc > 1)
+  {
+    out = fopen(argv[1], "w");
+    if (out == NULL)
+    {
+      fprintf(stderr, "failed to open %s\n", argv[1]);
+      return 1;
+    }
+  }
+  write_json(out);
+  if (out != stdout)
+  {
+    fclose(out);
+  }
+
+  host_screen_deinit();
+  return check_steady_state() ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+#include <math.h>
+#include <stdio.h>
+#include "pebble_host.h"
+
+// Built in place of the separate object to read the governor's state.
+#include "camera_controller.c"
+
+//==============================================================================
+// Frame pacing check: slow-mode transitions against a stand-in redraw that
+// advances the virtual clock by what it costs, with animation updates every
+// TICK_MS. One redraw in the first transition takes SLOW_REDRAW_MS: the
+// governor has to go back to rendering every update within RECOVERY_FRAMES,
+// start the next transition that way, and report the redraw itself, not the
+// interval around it, as the worst frame.
+
+#define TICK_MS FRAME_INTERVAL_MS
+#define REDRAW_MS 4
+#define SLOW_REDRAW_MS 200
+#define SLOW_FRAME 10
+// admitted frames after the slow one before the interval has to be back
+#define RECOVERY_FRAMES 4
+#define MAX_FRAMES 256
+
+//==============================================================================
+// Path check: one transition on each camera path. Every redrawn view has to
+// be look_at from the path's eye, which has to stay on the straight line
+// between the waypoints for the keyframes and on the circle through them for
+// the orbit.
+
+#define PATH_TOLERANCE 0.02f
+
+typedef struct TransitionTrace
+{
+  int frames;
+  uint32_t start_ms[MAX_FRAMES];
+  uint16_t worst_frame_ms;
+} TransitionTrace;
+
+static CameraController s_camera;
+static Layer *s_layer;
+static TransitionTrace *s_trace;
+static int s_slow_frame;
+
+static void invalidate_handler(void *context)
+{
+  layer_mark_dirty(s_layer);
+}
+
+static void update_proc(Layer *layer, GContext *ctx)
+{
+  if (s_trace->frames < MAX_FRAMES)
+  {
+    s_trace->start_ms[s_trace->frames] = host_clock_get_ms();
+  }
+  host_clock_advance(s_trace->frames == s_slow_frame ? SLOW_REDRAW_MS : REDRAW_MS);
+  ++s_trace->frames;
+  perf_log_frame_drawn();
+}
+
+static void run_transition(TransitionTrace *trace, int slow_frame)
+{
+  s_trace = trace;
+  s_slow_frame = slow_frame;
+  camera_controller_start_transition(&s_camera);
+  while (host_animations_active())
+  {
+    host_run_for(TICK_MS, TICK_MS);
+  }
+  trace->worst_frame_ms = s_camera.state->governor.worst_frame_ms;
+}
+
+typedef struct PathTrace
+{
+  int from_idx;
+  int frames;
+  // largest difference from look_at at the path's eye, and of that eye from the path
+  float view_error;
+  float eye_error;
+} PathTrace;
+
+static PathTrace *s_path_trace;
+
+static float distance_to_line(const Vec3 *eye, const Vec3 *from, const Vec3 *to)
+{
+  const float dx = scalar_to_float(to->x - from->x);
+  const float dy = scalar_to_float(to->y - from->y);
+  const float ex = scalar_to_float(eye->x - from->x);
+  const float ey = scalar_to_float(eye->y - from->y);
+
+  return fabsf(dx * ey - dy * ex) / sqrtf(dx * dx + dy * dy) + fabsf(scalar_to_float(eye->z - from->z));
+}
+
+static void path_update_proc(Layer *layer, GContext *ctx)
+{
+  static const Scalar SQRT2 = SCALAR(1.4142136f);
+  const CameraControllerState *state = s_camera.state;
+  const Vec3 at = Vec3(0, 0, 0);
+  const Vec3 up = Vec3(0, SCALAR_ONE, 0);
+  Vec3 eye = state->eye;
+  Mat4 expected;
+  float eye_error = 0;
+
+  if (state->path == CAMERA_PATH_ORBIT)
+  {
+    eye = Vec3(scalar_mul(SQRT2, scalar_from_fraction(cos_lookup(state->angle), TRIG_MAX_RATIO)),
+      scalar_mul(SQRT2, scalar_from_fraction(sin_lookup(state->angle), TRIG_MAX_RATIO)), SCALAR_ONE);
+    eye_error = fabsf(hypotf(scalar_to_float(eye.x), scalar_to_float(eye.y)) - sqrtf(2.0f));
+  }
+  else
+  {
+    eye_error = distance_to_line(&eye, &EYE_WAYPOINTS[s_path_trace->from_idx],
+      &EYE_WAYPOINTS[(s_path_trace->from_idx + 1) % WAYPOINT_COUNT]);
+  }
+
+  mat4_look_at_rh(&expected, &eye, &at, &up);
+  for (int i = 0; i < 16; ++i)
+  {
+    const float error = fabsf(scalar_to_float(state->view_matrix.m[i] - expected.m[i]));
+
+    s_path_trace->view_error = error > s_path_trace->view_error ? error : s_path_trace->view_error;
+  }
+  s_path_trace->eye_error = eye_error > s_path_trace->eye_error ? eye_error : s_path_trace->eye_error;
+  ++s_path_trace->frames;
+  host_clock_advance(REDRAW_MS);
+  perf_log_frame_drawn();
+}
+
+static void run_path(PathTrace *trace, CameraPath path)
+{
+  s_path_trace = trace;
+  trace->from_idx = camera_controller_get_waypoint_index(&s_camera);
+  camera_controller_set_path(&s_camera, path);
+  camera_controller_start_transition(&s_camera);
+  while (host_animations_active())
+  {
+    host_run_for(TICK_MS, TICK_MS);
+  }
+}
+
+static uint32_t frame_interval(const TransitionTrace *trace, int frame)
+{
+  return trace->start_ms[frame + 1] - trace->start_ms[frame];
+}
+
+// Intervals from first_frame on; the last frame is the final pose, which is
+// never held back.
+static uint32_t max_interval(const TransitionTrace *trace, int first_frame)
+{
+  uint32_t result = 0;
+
+  for (int i = first_frame; i + 2 < trace->frames; ++i)
+  {
+    result = frame_interval(trace, i) > result ? frame_interval(trace, i) : result;
+  }
+
+  return result;
+}
+
+int main(void)
+{
+  static TransitionTrace slow;
+  static TransitionTrace next;
+  PathTrace keyframes = { 0 };
+  PathTrace orbit = { 0 };
+  // one update per frame; the redraw pushes the next update back by its cost
+  const uint32_t limit = TICK_MS + REDRAW_MS;
+  bool ok = true;
+
+  host_screen_init(GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  s_layer = layer_create(layer_get_bounds(host_screen_get_root_layer()));
+  layer_set_update_proc(s_layer, update_proc);
+  layer_add_child(host_screen_get_root_layer(), s_layer);
+  if (!camera_controller_init(&s_camera, true, invalidate_handler, NULL))
+  {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+
+  run_transition(&slow, SLOW_FRAME);
+  run_transition(&next, -1);
+  layer_set_update_proc(s_layer, path_update_proc);
+  run_path(&keyframes, CAMERA_PATH_KEYFRAMES);
+  run_path(&orbit, CAMERA_PATH_ORBIT);
+
+  printf("slow transition   frames %3d  after the slow frame %u ms, then at most %u ms  worst frame %u ms\n",
+    slow.frames, (unsigned)frame_interval(&slow, SLOW_FRAME + 1),
+    (unsigned)max_interval(&slow, SLOW_FRAME + RECOVERY_FRAMES), (unsigned)slow.worst_frame_ms);
+  printf("next transition   frames %3d  at most %u ms  worst frame %u ms\n", next.frames,
+    (unsigned)max_interval(&next, 0), (unsigned)next.worst_frame_ms);
+  printf("keyframe path     frames %3d  view off look_at by %.4f  eye off the line by %.4f\n", keyframes.frames,
+    keyframes.view_error, keyframes.eye_error);
+  printf("orbit path        frames %3d  view off look_at by %.4f  eye off the circle by %.4f\n", orbit.frames,
+    orbit.view_error, orbit.eye_error);
+
+  if (slow.frames <= SLOW_FRAME + RECOVERY_FRAMES + 2 || slow.frames > MAX_FRAMES || next.frames > MAX_FRAMES)
+  {
+    fprintf(stderr, "FAIL: unexpected frame counts\n");
+    ok = false;
+  }
+  else
+  {
+    if (max_interval(&slow, SLOW_FRAME + RECOVERY_FRAMES) > limit)
+    {
+      fprintf(stderr, "FAIL: the interval did not recover after the slow frame\n");
+      ok = false;
+    }
+    if (max_interval(&next, 0) > limit)
+    {
+      fprintf(stderr, "FAIL: the slow frame carried over into the next transition\n");
+      ok = false;
+    }
+    if (slow.worst_frame_ms != SLOW_REDRAW_MS || next.worst_frame_ms != REDRAW_MS)
+    {
+      fprintf(stderr, "FAIL: worst frame is not the redraw cost\n");
+      ok = false;
+    }
+  }
+
+  if (keyframes.frames == 0 || orbit.frames == 0)
+  {
+    fprintf(stderr, "FAIL: a camera path drew no frames\n");
+    ok = false;
+  }
+  if (keyframes.view_error > PATH_TOLERANCE || keyframes.eye_error > PATH_TOLERANCE)
+  {
+    fprintf(stderr, "FAIL: the keyframe path left the straight line between the waypoints\n");
+    ok = false;
+  }
+  if (orbit.view_error > PATH_TOLERANCE || orbit.eye_error > PATH_TOLERANCE)
+  {
+    fprintf(stderr, "FAIL: the orbit path left the circle through the waypoints\n");
+    ok = false;
+  }
+
+  camera_controller_deinit(&s_camera);
+  layer_destroy(s_layer);
+  host_screen_deinit();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,404 @@
+#pragma once
+
+//==============================================================================
+// Host stand-in for the subset of the Pebble SDK used by src/c.
+//
+// Platform defines (PBL_BW / PBL_COLOR, PBL_RECT / PBL_ROUND,
+// PBL_PLATFORM_*) come from the Makefile, the same way the SDK passes them on
+// the compiler command line.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
+
+#if defined(PBL_BW)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_false)
+#else
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_false)
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#endif
+
+#if defined(PBL_ROUND)
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+#endif
+
+//==============================================================================
+// logging
+
+typedef enum
+{
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+  __attribute__((format(printf, 4, 5)));
+
+#define APP_LOG(level, fmt, ...) app_log((level), __FILE__, __LINE__, (fmt), ##__VA_ARGS__)
+
+//==============================================================================
+// geometry
+
+typedef struct GPoint
+{
+  int16_t x;
+  int16_t y;
+} GPoint;
+
+typedef struct GSize
+{
+  int16_t w;
+  int16_t h;
+} GSize;
+
+typedef struct GRect
+{
+  GPoint origin;
+  GSize size;
+} GRect;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPointZero GPoint(0, 0)
+#define GRectZero GRect(0, 0, 0, 0)
+
+GPoint grect_center_point(const GRect *rect);
+bool grect_equal(const GRect *rect_a, const GRect *rect_b);
+bool gpoint_equal(const GPoint *point_a, const GPoint *point_b);
+
+//==============================================================================
+// colors
+
+typedef union GColor8
+{
+  uint8_t argb;
+  struct
+  {
+    uint8_t b:2;
+    uint8_t g:2;
+    uint8_t r:2;
+    uint8_t a:2;
+  };
+} GColor8;
+
+typedef GColor8 GColor;
+
+#define GColorARGB8FromRGBA(red, green, blue, alpha) \
+  (uint8_t)((((alpha) >> 6) << 6) | (((red) >> 6) << 4) | (((green) >> 6) << 2) | ((blue) >> 6))
+#define GColorFromRGBA(red, green, blue, alpha) ((GColor8){ .argb = GColorARGB8FromRGBA(red, green, blue, alpha) })
+#define GColorFromRGB(red, green, blue) GColorFromRGBA(red, green, blue, 255)
+#define GColorFromHEX(v) GColorFromRGB((((v) >> 16) & 0xff), (((v) >> 8) & 0xff), ((v) & 0xff))
+
+#define GColorBlack ((GColor8){ .argb = 0xC0 })
+#define GColorWhite ((GColor8){ .argb = 0xFF })
+#define GColorClear ((GColor8){ .argb = 0x00 })
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+
+//==============================================================================
+// bitmaps
+
+typedef enum GBitmapFormat
+{
+  GBitmapFormat1Bit = 0,
+  GBitmapFormat8Bit,
+  GBitmapFormat1BitPalette,
+  GBitmapFormat2BitPalette,
+  GBitmapFormat4BitPalette,
+  GBitmapFormat8BitCircular,
+} GBitmapFormat;
+
+typedef struct GBitmapDataRowInfo
+{
+  uint8_t *data;
+  int16_t min_x;
+  int16_t max_x;
+} GBitmapDataRowInfo;
+
+typedef struct GBitmap GBitmap;
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format);
+void gbitmap_destroy(GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
+
+//==============================================================================
+// graphics
+
+typedef struct GContext GContext;
+
+typedef enum
+{
+  GCompOpAssign,
+  GCompOpAssignInverted,
+  GCompOpOr,
+  GCompOpAnd,
+  GCompOpClear,
+  GCompOpSet,
+} GCompOp;
+
+typedef enum
+{
+  GCornerNone = 0,
+  GCornersAll = 0xf,
+} GCornerMask;
+
+typedef struct GPathInfo
+{
+  uint32_t num_points;
+  GPoint *points;
+} GPathInfo;
+
+typedef struct GPath
+{
+  uint32_t num_points;
+  GPoint *points;
+  int32_t rotation;
+  GPoint offset;
+} GPath;
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_antialiased(GContext *ctx, bool enable);
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode);
+void gpath_draw_filled(GContext *ctx, GPath *path);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+
+//==============================================================================
+// layers
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+Layer *layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void *layer_get_data(const Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_mark_dirty(Layer *layer);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_bounds(Layer *layer, GRect bounds);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+
+//==============================================================================
+// time
+
+typedef enum
+{
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+bool clock_is_24h_style(void);
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer);
+
+//==============================================================================
+// animation
+
+typedef struct Animation Animation;
+typedef uint32_t AnimationProgress;
+
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+
+typedef void (*AnimationSetupImplementation)(Animation *animation);
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+typedef void (*AnimationTeardownImplementation)(Animation *animation);
+
+typedef struct AnimationImplementation
+{
+  AnimationSetupImplementation setup;
+  AnimationUpdateImplementation update;
+  AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+typedef void (*AnimationStartedHandler)(Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(Animation *animation, bool finished, void *context);
+
+typedef struct AnimationHandlers
+{
+  AnimationStartedHandler started;
+  AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+Animation *animation_create(void);
+bool animation_destroy(Animation *animation);
+bool animation_set_delay(Animation *animation, uint32_t delay_ms);
+bool animation_set_duration(Animation *animation, uint32_t duration_ms);
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+void *animation_get_context(Animation *animation);
+bool animation_schedule(Animation *animation);
+bool animation_unschedule(Animation *animation);
+bool animation_is_scheduled(Animation *animation);
+
+//==============================================================================
+// trig
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+
+//==============================================================================
+// battery
+
+typedef struct BatteryChargeState
+{
+  uint8_t charge_percent;
+  bool is_charging;
+  bool is_plugged;
+} BatteryChargeState;
+
+BatteryChargeState battery_state_service_peek(void);
+
+//==============================================================================
+// memory
+
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+
+//==============================================================================
+// persistent storage
+
+#define PERSIST_DATA_MAX_LENGTH 256
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_write_bool(const uint32_t key, const bool value);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_delete(const uint32_t key);
+
+//==============================================================================
+// resources (ids normally come from the SDK's resource_ids.auto.h)
+
+#define RESOURCE_ID_DIGIT_ATLAS 1
+
+typedef void *ResHandle;
+
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_size(ResHandle h);
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes);
+
+//==============================================================================
+// app message
+
+typedef enum
+{
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((__packed__)) Tuple
+{
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  union
+  {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+typedef struct DictionaryIterator
+{
+  uint8_t *dictionary;
+  const uint8_t *end;
+  Tuple *cursor;
+} DictionaryIterator;
+
+typedef enum
+{
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_APP_NOT_RUNNING = 1 << 4,
+  APP_MSG_INVALID_ARGS = 1 << 5,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_OUT_OF_MEMORY = 1 << 9,
+  APP_MSG_CLOSED = 1 << 10,
+  APP_MSG_INTERNAL_ERROR = 1 << 11,
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+Tuple *dict_read_first(DictionaryIterator *iter);
+Tuple *dict_read_next(DictionaryIterator *iter);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+int dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed);
+int dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size);
+
+// Generated by the SDK from package.json "messageKeys".
+#define MESSAGE_KEY_SETTING_SLOW_VERSION 0
+#define MESSAGE_KEY_SETTING_BG_COLOR 1
+#define MESSAGE_KEY_SETTING_FACE_COLOR 2
+#define MESSAGE_KEY_SETTING_LINE_COLOR 3
+#define MESSAGE_KEY_SETTING_FACE_MIX_WITH_BACKGROUND 4
+#define MESSAGE_KEY_SETTING_LINE_MIX_WITH_BACKGROUND 5
+#define MESSAGE_KEY_SETTING_SPLIT_LINE_COLORS 6
+#define MESSAGE_KEY_SETTING_BACK_LINE_COLOR 7
+#define MESSAGE_KEY_SETTING_SIDE_LINE_COLOR 8
+#define MESSAGE_KEY_PERF_REQUEST 9
+#define MESSAGE_KEY_PERF_RECORDS 10
+#define MESSAGE_KEY_SETTINGS_DELTA 11
+#define MESSAGE_KEY_SETTINGS_CHECKSUM 12
@@ -0,0 +1,59 @@
+#pragma once
+
+//==============================================================================
+// Harness-side controls for the host stand-in. Nothing in src/c includes this.
+
+#include <pebble.h>
+
+typedef struct HostStats
+{
+  uint32_t layer_updates;
+  uint32_t fill_calls;
+  uint32_t line_calls;
+  uint32_t rect_calls;
+  uint32_t bitmap_calls;
+  uint32_t fill_color_changes;
+  uint32_t stroke_color_changes;
+  uint32_t framebuffer_captures;
+  uint32_t pixels_written;
+  // layers, bitmaps, animations and timers created: each a heap block on the watch
+  uint32_t heap_allocations;
+  // the same blocks destroyed, or freed by the system (fired timers, stopped animations)
+  uint32_t heap_frees;
+} HostStats;
+
+void host_screen_init(GSize size);
+void host_screen_deinit(void);
+GSize host_screen_get_size(void);
+GBitmap *host_screen_get_bitmap(void);
+Layer *host_screen_get_root_layer(void);
+void host_screen_set_background_color(GColor color);
+
+void host_render(void);
+void host_render_layer(Layer *layer);
+bool host_render_pending(void);
+bool host_write_ppm(const char *path);
+
+void host_stats_reset(void);
+const HostStats *host_stats_get(void);
+
+uint32_t host_clock_get_ms(void);
+void host_clock_advance(uint32_t ms);
+void host_run_for(uint32_t ms, uint32_t frame_ms);
+bool host_animations_active(void);
+
+void host_battery_set(uint8_t charge_percent, bool is_charging);
+
+void host_dict_begin(uint8_t *buffer, size_t size, DictionaryIterator *iter);
+void host_dict_add_int32(DictionaryIterator *iter, uint32_t key, int32_t value);
+void host_dict_add_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t size);
+void host_dict_end(DictionaryIterator *iter);
+void host_app_message_deliver(DictionaryIterator *iter);
+DictionaryIterator *host_app_message_last_sent(void);
+
+// Backs resource_id with the contents of a file; resources without a file
+// have no handle.
+bool host_resource_load(uint32_t resource_id, const char *path);
+
+void host_persist_reset(void);
+uint32_t host_persist_write_count(void);
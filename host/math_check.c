@@ -0,0 +1,207 @@
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "math_helper.h"
+
+//==============================================================================
+// Accuracy and frame-cost check for the math_helper backend this binary was
+// built with (float or MATH_FIXED_POINT), against a double precision reference
+// of the same camera and projection the watchface uses.
+
+#define GRID_POINT_COUNT 20
+#define DIGIT_COUNT 4
+#define SAMPLES_PER_TRANSITION 64
+#define TIMING_FRAMES 20000
+
+typedef struct RefVec3
+{
+  double x, y, z;
+} RefVec3;
+
+static const double EYE_WAYPOINTS[][2] = {
+  { 1, 1 },
+  { 1, -1 },
+  { -1, -1 },
+  { -1, 1 }
+};
+
+// 144x168 layout: poly_scale 1.4, digit offsets 35 / 42
+static const double POLY_SCALE = 1.4;
+static const double DIGIT_OFFSETS[DIGIT_COUNT][2] = {
+  { -35, 42 },
+  { 35, 42 },
+  { -35, -42 },
+  { 35, -42 }
+};
+
+static RefVec3 ref_cross(RefVec3 a, RefVec3 b)
+{
+  return (RefVec3){ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static RefVec3 ref_normalized(RefVec3 v)
+{
+  double length = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+  return (RefVec3){ v.x / length, v.y / length, v.z / length };
+}
+
+// Same basis as mat4_look_at_rh, at = origin and up = +y.
+static void ref_project(double eye_x, double eye_y, RefVec3 p, double *out_x, double *out_y)
+{
+  RefVec3 eye = { eye_x, eye_y, 1 };
+  RefVec3 f = ref_normalized((RefVec3){ -eye.x, -eye.y, -eye.z });
+  RefVec3 s = ref_cross(f, (RefVec3){ 0, 1, 0 });
+  RefVec3 u = ref_cross(s, f);
+  RefVec3 d = { p.x - eye.x, p.y - eye.y, p.z - eye.z };
+
+  *out_x = s.x * d.x + s.y * d.y + s.z * d.z;
+  *out_y = u.x * d.x + u.y * d.y + u.z * d.z;
+}
+
+static RefVec3 world_point(int digit, int point, double z)
+{
+  double x = (point % 4) * 10.0;
+  double y = (point / 4) * 10.0;
+
+  return (RefVec3){
+    DIGIT_OFFSETS[digit][0] + (x - 15) * POLY_SCALE,
+    DIGIT_OFFSETS[digit][1] + (y - 20) * POLY_SCALE,
+    (z - 6) * POLY_SCALE
+  };
+}
+
+static Vec3 to_vec3(RefVec3 v)
+{
+  return Vec3(scalar_from_float((float)v.x), scalar_from_float((float)v.y), scalar_from_float((float)v.z));
+}
+
+static void eye_at(int transition, int sample, double *out_x, double *out_y)
+{
+  const double *from = EYE_WAYPOINTS[transition];
+  const double *to = EYE_WAYPOINTS[(transition + 1) % 4];
+  double ratio = (double)sample / SAMPLES_PER_TRANSITION;
+
+  *out_x = from[0] * (1 - ratio) + to[0] * ratio;
+  *out_y = from[1] * (1 - ratio) + to[1] * ratio;
+}
+
+static void check_accuracy(void)
+{
+  const Vec3 at = Vec3(0, 0, 0);
+  const Vec3 up = Vec3(0, SCALAR_ONE, 0);
+  double max_error = 0;
+  double error_sum = 0;
+  int rounding_mismatches = 0;
+  int point_count = 0;
+
+  for (int transition = 0; transition < 4; ++transition)
+  {
+    for (int sample = 0; sample < SAMPLES_PER_TRANSITION; ++sample)
+    {
+      double eye_x, eye_y;
+      Mat4 view;
+      Vec3 eye;
+
+      eye_at(transition, sample, &eye_x, &eye_y);
+      eye = Vec3(scalar_from_float((float)eye_x), scalar_from_float((float)eye_y), SCALAR_ONE);
+      mat4_look_at_rh(&view, &eye, &at, &up);
+
+      for (int digit = 0; digit < DIGIT_COUNT; ++digit)
+      {
+        for (int i = 0; i < GRID_POINT_COUNT * 2; ++i)
+        {
+          RefVec3 world = world_point(digit, i % GRID_POINT_COUNT, i < GRID_POINT_COUNT ? 0 : 10);
+          Vec3 world_v = to_vec3(world);
+          Vec3 view_pos;
+          double ref_x, ref_y;
+
+          ref_project(eye_x, eye_y, world, &ref_x, &ref_y);
+          mat4_multiply_vec3(&view_pos, &view, &world_v);
+
+          double error_x = fabs(scalar_to_float(view_pos.x) - ref_x);
+          double error_y = fabs(scalar_to_float(view_pos.y) - ref_y);
+          double error = error_x > error_y ? error_x : error_y;
+
+          max_error = error > max_error ? error : max_error;
+          error_sum += error;
+          rounding_mismatches += scalar_round_to_int(view_pos.x) != (int)lround(ref_x) ||
+            scalar_round_to_int(view_pos.y) != (int)lround(ref_y);
+          point_count++;
+        }
+      }
+    }
+  }
+
+  printf("accuracy: points=%d max_error_px=%.4f mean_error_px=%.5f rounding_mismatches=%d (%.2f%%)\n",
+    point_count, max_error, error_sum / point_count, rounding_mismatches,
+    100.0 * rounding_mismatches / point_count);
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void check_frame_cost(void)
+{
+  const Vec3 at = Vec3(0, 0, 0);
+  const Vec3 up = Vec3(0, SCALAR_ONE, 0);
+  Vec3 points[DIGIT_COUNT][GRID_POINT_COUNT * 2];
+  Vec3 eyes[4 * SAMPLES_PER_TRANSITION];
+  volatile Scalar sink = 0;
+  double start;
+  double elapsed;
+
+  for (int digit = 0; digit < DIGIT_COUNT; ++digit)
+  {
+    for (int i = 0; i < GRID_POINT_COUNT * 2; ++i)
+    {
+      points[digit][i] = to_vec3(world_point(digit, i % GRID_POINT_COUNT, i < GRID_POINT_COUNT ? 0 : 10));
+    }
+  }
+
+  for (int i = 0; i < 4 * SAMPLES_PER_TRANSITION; ++i)
+  {
+    double eye_x, eye_y;
+
+    eye_at(i / SAMPLES_PER_TRANSITION, i % SAMPLES_PER_TRANSITION, &eye_x, &eye_y);
+    eyes[i] = Vec3(scalar_from_float((float)eye_x), scalar_from_float((float)eye_y), SCALAR_ONE);
+  }
+
+  // One animation frame: a look_at plus every vertex of the four digits.
+  start = now_ns();
+  for (int frame = 0; frame < TIMING_FRAMES; ++frame)
+  {
+    Mat4 view;
+
+    mat4_look_at_rh(&view, &eyes[frame % (4 * SAMPLES_PER_TRANSITION)], &at, &up);
+    for (int digit = 0; digit < DIGIT_COUNT; ++digit)
+    {
+      for (int i = 0; i < GRID_POINT_COUNT * 2; ++i)
+      {
+        Vec3 view_pos;
+        mat4_multiply_vec3(&view_pos, &view, &points[digit][i]);
+        sink += view_pos.x + view_pos.y;
+      }
+    }
+  }
+  elapsed = now_ns() - start;
+
+  printf("frame cost: %.0f ns/frame (look_at + %d transforms, host CPU)\n",
+    elapsed / TIMING_FRAMES, DIGIT_COUNT * GRID_POINT_COUNT * 2);
+}
+
+int main(void)
+{
+#ifdef MATH_FIXED_POINT
+  printf("backend: Q16.16 fixed point\n");
+#else
+  printf("backend: float\n");
+#endif
+
+  check_accuracy();
+  check_frame_cost();
+  return 0;
+}
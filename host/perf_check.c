@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include "pebble_host.h"
+#include "perf_log.h"
+
+//==============================================================================
+// Perf log check: LAUNCHES launches of TRANSITIONS transitions each, with
+// persistent storage kept between them, then a request from the phone. The
+// reply has to hold the last PERF_LOG_LAUNCH_CAPACITY launches and the last
+// PERF_LOG_CAPACITY transitions, each ring oldest first, and each launch has
+// to write the log once, on deinit.
+
+#define LAUNCHES 3
+#define TRANSITIONS 20
+#define LAUNCH_MS(launch) (100 + (launch) * 10)
+#define FRAMES(launch, transition) ((launch) * TRANSITIONS + (transition) + 1)
+
+static void inbox_received(DictionaryIterator *iterator, void *context)
+{
+  perf_log_apply_message(iterator);
+}
+
+static void run_launch(int launch)
+{
+  perf_log_init();
+  host_clock_advance(LAUNCH_MS(launch));
+  perf_log_frame_drawn();
+  for (int t = 0; t < TRANSITIONS; ++t)
+  {
+    host_clock_advance(1000);
+    perf_log_frame_drawn();
+    perf_log_record_transition(FRAMES(launch, t), (uint16_t)t);
+  }
+  perf_log_deinit();
+}
+
+static bool check_record(const PerfRecord *record, PerfRecordKind kind, int frames, int time_ms)
+{
+  if (record->kind == kind && record->frames == frames && record->time_ms == time_ms)
+  {
+    return true;
+  }
+
+  fprintf(stderr, "FAIL: record kind %d frames %d time %d ms, expected kind %d frames %d time %d ms\n",
+    record->kind, record->frames, record->time_ms, kind, frames, time_ms);
+  return false;
+}
+
+int main(void)
+{
+  uint8_t buffer[64];
+  DictionaryIterator request;
+  DictionaryIterator *reply;
+  const Tuple *tuple;
+  const PerfRecord *records;
+  int count;
+  bool ok = true;
+
+  host_persist_reset();
+  for (int launch = 0; launch < LAUNCHES; ++launch)
+  {
+    run_launch(launch);
+  }
+  printf("%d launches of %d transitions  %u persist writes\n", LAUNCHES, TRANSITIONS,
+    (unsigned)host_persist_write_count());
+  if (host_persist_write_count() != LAUNCHES)
+  {
+    fprintf(stderr, "FAIL: %u persist writes, expected one per launch\n", (unsigned)host_persist_write_count());
+    ok = false;
+  }
+
+  perf_log_init();
+  app_message_register_inbox_received(inbox_received);
+  host_dict_begin(buffer, sizeof(buffer), &request);
+  host_dict_add_int32(&request, MESSAGE_KEY_PERF_REQUEST, 1);
+  host_dict_end(&request);
+  host_app_message_deliver(&request);
+
+  reply = host_app_message_last_sent();
+  tuple = reply != NULL ? dict_find(reply, MESSAGE_KEY_PERF_RECORDS) : NULL;
+  if (tuple == NULL)
+  {
+    fprintf(stderr, "FAIL: no records sent\n");
+    return 1;
+  }
+
+  records = (const PerfRecord *)tuple->value->data;
+  count = tuple->length / sizeof(PerfRecord);
+  printf("sent %d records\n", count);
+  if (count != PERF_LOG_LAUNCH_CAPACITY + PERF_LOG_CAPACITY)
+  {
+    fprintf(stderr, "FAIL: expected %d records\n", PERF_LOG_LAUNCH_CAPACITY + PERF_LOG_CAPACITY);
+    return 1;
+  }
+
+  for (int i = 0; i < PERF_LOG_LAUNCH_CAPACITY; ++i)
+  {
+    const int launch = LAUNCHES - PERF_LOG_LAUNCH_CAPACITY + i;
+
+    ok = check_record(&records[i], PERF_RECORD_LAUNCH, 0, LAUNCH_MS(launch)) && ok;
+  }
+  for (int i = 0; i < PERF_LOG_CAPACITY; ++i)
+  {
+    const int t = TRANSITIONS - PERF_LOG_CAPACITY + i;
+
+    ok = check_record(&records[PERF_LOG_LAUNCH_CAPACITY + i], PERF_RECORD_TRANSITION,
+      FRAMES(LAUNCHES - 1, t), t) && ok;
+  }
+
+  perf_log_deinit();
+  return ok ? 0 : 1;
+}
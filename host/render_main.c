@@ -0,0 +1,119 @@
+#include "pebble_host.h"
+#include "app_settings.h"
+#include "camera_controller.h"
+#include "clock_digits.h"
+#include "digit_renderer.h"
+#include "profiler.h"
+
+//==============================================================================
+// Headless driver mirroring the wiring in src/c/main.c.
+
+static AppSettings s_settings;
+static CameraController s_camera_controller;
+static DigitRenderer s_digit_renderer;
+
+static void invalidate_digit_layers(void *context)
+{
+  if (!digit_renderer_is_ready(&s_digit_renderer))
+  {
+    return;
+  }
+
+  digit_renderer_update_view(&s_digit_renderer,
+    camera_controller_get_waypoint_index(&s_camera_controller));
+}
+
+#ifdef PROFILER_ENABLED
+// One line per transition; the virtual clock stands still while drawing, so
+// only the frame count and counters mean anything here.
+static void print_profile(const ProfileSummary *summary, void *context)
+{
+  const uint32_t frames = summary->frames > 0 ? summary->frames : 1;
+
+  fprintf(stderr, "transition: %u frames, %u over %u ms; per frame %u transforms, %u fills, %u lines, "
+    "%u stroke colors\n", summary->frames, summary->budget_misses, summary->budget_ms,
+    (unsigned)(summary->counters[PROFILE_COUNTER_TRANSFORMS] / frames),
+    (unsigned)(summary->counters[PROFILE_COUNTER_FILLS] / frames),
+    (unsigned)(summary->counters[PROFILE_COUNTER_LINES] / frames),
+    (unsigned)(summary->counters[PROFILE_COUNTER_STROKE_COLORS] / frames));
+}
+#endif
+
+static void set_time(int hour, int minute)
+{
+  struct tm time_value = { 0 };
+  ClockDigits digits;
+
+  time_value.tm_hour = hour;
+  time_value.tm_min = minute;
+  clock_digits_from_time(&time_value, true, &digits);
+  for (int i = 0; i < CLOCK_DIGIT_COUNT; ++i)
+  {
+    digit_renderer_set_digit(&s_digit_renderer, i, digits.value[i], digits.hidden[i]);
+  }
+}
+
+static void dump_frame(const char *out_dir, int index)
+{
+  char path[512];
+
+  snprintf(path, sizeof(path), "%s/frame_%04d.ppm", out_dir, index);
+  if (!host_write_ppm(path))
+  {
+    fprintf(stderr, "failed to write %s\n", path);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const char *out_dir = argc > 1 ? argv[1] : ".";
+  int transitions = argc > 2 ? atoi(argv[2]) : 4;
+  // render <out_dir> <transitions> <atlas or ""> <per-digit | single> <keyframes | orbit>
+  const DigitRendererLayout layout = argc > 4 && strcmp(argv[4], "single") == 0
+    ? DIGIT_RENDERER_SINGLE_LAYER : DIGIT_RENDERER_LAYER_PER_DIGIT;
+  const CameraPath path = argc > 5 && strcmp(argv[5], "orbit") == 0 ? CAMERA_PATH_ORBIT : CAMERA_PATH_KEYFRAMES;
+  int frame = 0;
+  const uint32_t frame_ms = 33;
+
+  host_screen_init(GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  app_settings_load(&s_settings);
+  if (argc > 3 && argv[3][0] != '\0' && !host_resource_load(RESOURCE_ID_DIGIT_ATLAS, argv[3]))
+  {
+    fprintf(stderr, "failed to load %s\n", argv[3]);
+    return 1;
+  }
+  host_screen_set_background_color(app_settings_get_background_color(&s_settings));
+  PROFILE_SET_SINK(print_profile, NULL);
+
+  if (!camera_controller_init(&s_camera_controller, s_settings.slow_version, invalidate_digit_layers, NULL) ||
+    !digit_renderer_init(&s_digit_renderer, host_screen_get_root_layer(), &s_settings,
+      camera_controller_get_view_matrix(&s_camera_controller), layout))
+  {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+  camera_controller_set_path(&s_camera_controller, path);
+  invalidate_digit_layers(NULL);
+
+  set_time(12, 34);
+  host_render();
+  dump_frame(out_dir, frame++);
+
+  for (int t = 0; t < transitions; ++t)
+  {
+    set_time(12, 35 + t);
+    camera_controller_start_transition(&s_camera_controller);
+    while (host_animations_active())
+    {
+      host_run_for(frame_ms, frame_ms);
+      dump_frame(out_dir, frame++);
+    }
+  }
+
+  printf("%d frames written to %s\n", frame, out_dir);
+
+  digit_renderer_deinit(&s_digit_renderer);
+  camera_controller_deinit(&s_camera_controller);
+  host_screen_deinit();
+  return 0;
+}
@@ -0,0 +1,539 @@
+#include <math.h>
+#include "pebble_host.h"
+#include "host_private.h"
+
+struct GBitmap
+{
+  GSize size;
+  GBitmapFormat format;
+  uint16_t bytes_per_row;
+  uint8_t *data;
+};
+
+static GContext s_context;
+static GBitmap *s_screen;
+static HostStats s_stats;
+
+//==============================================================================
+// geometry / color
+
+GPoint grect_center_point(const GRect *rect)
+{
+  return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+bool grect_equal(const GRect *rect_a, const GRect *rect_b)
+{
+  return rect_a->origin.x == rect_b->origin.x && rect_a->origin.y == rect_b->origin.y &&
+    rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+bool gpoint_equal(const GPoint *point_a, const GPoint *point_b)
+{
+  return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool gcolor_equal(GColor8 x, GColor8 y)
+{
+  return x.argb == y.argb || (x.a == 0 && y.a == 0);
+}
+
+static bool color_is_white(GColor color)
+{
+  // Same threshold the 1-bit displays use: anything at least half bright is white.
+  return (color.r + color.g + color.b) >= 5;
+}
+
+//==============================================================================
+// bitmaps
+
+static uint16_t bytes_per_row_for(GSize size, GBitmapFormat format)
+{
+  if (format == GBitmapFormat1Bit)
+  {
+    return (uint16_t)(((size.w + 31) / 32) * 4);
+  }
+
+  return (uint16_t)size.w;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format)
+{
+  GBitmap *bitmap;
+
+  if (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit && format != GBitmapFormat8BitCircular)
+  {
+    return NULL;
+  }
+
+  s_stats.heap_allocations++;
+  bitmap = malloc(sizeof(GBitmap));
+  if (bitmap == NULL)
+  {
+    return NULL;
+  }
+
+  bitmap->size = size;
+  bitmap->format = format;
+  bitmap->bytes_per_row = bytes_per_row_for(size, format);
+  bitmap->data = calloc((size_t)bitmap->bytes_per_row * size.h, 1);
+  if (bitmap->data == NULL)
+  {
+    free(bitmap);
+    return NULL;
+  }
+
+  return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap)
+{
+  if (bitmap == NULL)
+  {
+    return;
+  }
+
+  s_stats.heap_frees++;
+  free(bitmap->data);
+  free(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap)
+{
+  return GRect(0, 0, bitmap->size.w, bitmap->size.h);
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap)
+{
+  return bitmap->bytes_per_row;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap)
+{
+  return bitmap->format;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap)
+{
+  return bitmap->data;
+}
+
+static void circular_row_extent(const GBitmap *bitmap, int y, int16_t *out_min_x, int16_t *out_max_x)
+{
+  // Pixel rows of a round display only cover the chord of the circle.
+  const float radius = bitmap->size.w / 2.0f;
+  const float dy = (y + 0.5f) - bitmap->size.h / 2.0f;
+  float half = radius * radius - dy * dy;
+  int span = half > 0 ? (int)(sqrtf(half) + 0.5f) : 0;
+
+  *out_min_x = (int16_t)(bitmap->size.w / 2 - span);
+  *out_max_x = (int16_t)(bitmap->size.w / 2 + span - 1);
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y)
+{
+  GBitmapDataRowInfo info;
+
+  info.data = bitmap->data + (size_t)y * bitmap->bytes_per_row;
+  info.min_x = 0;
+  info.max_x = (int16_t)(bitmap->size.w - 1);
+  if (bitmap->format == GBitmapFormat8BitCircular)
+  {
+    circular_row_extent(bitmap, y, &info.min_x, &info.max_x);
+  }
+
+  return info;
+}
+
+static void bitmap_put_pixel(GBitmap *bitmap, int x, int y, GColor color)
+{
+  if (x < 0 || y < 0 || x >= bitmap->size.w || y >= bitmap->size.h)
+  {
+    return;
+  }
+
+  if (bitmap->format == GBitmapFormat1Bit)
+  {
+    uint8_t *byte = &bitmap->data[y * bitmap->bytes_per_row + x / 8];
+    uint8_t mask = (uint8_t)(1 << (x % 8));
+    *byte = color_is_white(color) ? (*byte | mask) : (*byte & ~mask);
+    return;
+  }
+
+  if (bitmap->format == GBitmapFormat8BitCircular)
+  {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap, (uint16_t)y);
+    if (x < info.min_x || x > info.max_x)
+    {
+      return;
+    }
+  }
+
+  bitmap->data[y * bitmap->bytes_per_row + x] = color.argb;
+}
+
+static GColor bitmap_get_pixel(const GBitmap *bitmap, int x, int y)
+{
+  if (bitmap->format == GBitmapFormat1Bit)
+  {
+    uint8_t byte = bitmap->data[y * bitmap->bytes_per_row + x / 8];
+    return (byte & (1 << (x % 8))) ? GColorWhite : GColorBlack;
+  }
+
+  return (GColor){ .argb = bitmap->data[y * bitmap->bytes_per_row + x] };
+}
+
+//==============================================================================
+// screen
+
+void host_screen_create_bitmap(GSize size)
+{
+#if defined(PBL_BW)
+  s_screen = gbitmap_create_blank(size, GBitmapFormat1Bit);
+#elif defined(PBL_ROUND)
+  s_screen = gbitmap_create_blank(size, GBitmapFormat8BitCircular);
+#else
+  s_screen = gbitmap_create_blank(size, GBitmapFormat8Bit);
+#endif
+  memset(&s_context, 0, sizeof(s_context));
+  s_context.stroke_color = GColorBlack;
+  s_context.fill_color = GColorBlack;
+}
+
+void host_screen_destroy_bitmap(void)
+{
+  gbitmap_destroy(s_screen);
+  s_screen = NULL;
+}
+
+GBitmap *host_screen_get_bitmap(void)
+{
+  return s_screen;
+}
+
+GContext *host_context_begin(GRect clip, GPoint offset)
+{
+  // Like the firmware, every layer starts from the default draw state.
+  s_context.fill_color = GColorBlack;
+  s_context.stroke_color = GColorBlack;
+  s_context.compositing_mode = GCompOpAssign;
+  s_context.clip = clip;
+  s_context.offset = offset;
+  return &s_context;
+}
+
+void host_screen_clear(GColor color)
+{
+  for (int y = 0; y < s_screen->size.h; ++y)
+  {
+    for (int x = 0; x < s_screen->size.w; ++x)
+    {
+      bitmap_put_pixel(s_screen, x, y, color);
+    }
+  }
+}
+
+bool host_write_ppm(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+
+  if (file == NULL)
+  {
+    return false;
+  }
+
+  fprintf(file, "P6\n%d %d\n255\n", s_screen->size.w, s_screen->size.h);
+  for (int y = 0; y < s_screen->size.h; ++y)
+  {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(s_screen, (uint16_t)y);
+
+    for (int x = 0; x < s_screen->size.w; ++x)
+    {
+      GColor color = bitmap_get_pixel(s_screen, x, y);
+      uint8_t rgb[3] = { (uint8_t)(color.r * 85), (uint8_t)(color.g * 85), (uint8_t)(color.b * 85) };
+
+      if (x < info.min_x || x > info.max_x)
+      {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+      }
+
+      fwrite(rgb, 1, 3, file);
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+//==============================================================================
+// stats
+
+void host_stats_reset(void)
+{
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+const HostStats *host_stats_get(void)
+{
+  return &s_stats;
+}
+
+HostStats *host_stats_mutable(void)
+{
+  return &s_stats;
+}
+
+//==============================================================================
+// drawing
+
+static void context_put_pixel(GContext *ctx, int x, int y, GColor color)
+{
+  int screen_x = x + ctx->offset.x;
+  int screen_y = y + ctx->offset.y;
+
+  if (screen_x < ctx->clip.origin.x || screen_y < ctx->clip.origin.y ||
+    screen_x >= ctx->clip.origin.x + ctx->clip.size.w ||
+    screen_y >= ctx->clip.origin.y + ctx->clip.size.h)
+  {
+    return;
+  }
+
+  if (ctx->framebuffer_captured)
+  {
+    fprintf(stderr, "host: drawing while the frame buffer is captured\n");
+    abort();
+  }
+
+  bitmap_put_pixel(s_screen, screen_x, screen_y, color);
+  s_stats.pixels_written++;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color)
+{
+  s_stats.fill_color_changes++;
+  ctx->fill_color = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color)
+{
+  s_stats.stroke_color_changes++;
+  ctx->stroke_color = color;
+}
+
+void graphics_context_set_antialiased(GContext *ctx, bool enable)
+{
+  ctx->antialiased = enable;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode)
+{
+  ctx->compositing_mode = mode;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+void gpath_draw_filled(GContext *ctx, GPath *path)
+{
+  int min_y = INT16_MAX;
+  int max_y = INT16_MIN;
+  int crossings[64];
+
+  s_stats.fill_calls++;
+  if (path->num_points < 3)
+  {
+    return;
+  }
+
+  for (uint32_t i = 0; i < path->num_points; ++i)
+  {
+    int y = path->points[i].y + path->offset.y;
+    min_y = y < min_y ? y : min_y;
+    max_y = y > max_y ? y : max_y;
+  }
+
+  // Even-odd scanline fill sampled at pixel centers.
+  for (int y = min_y; y <= max_y; ++y)
+  {
+    float sample_y = y + 0.5f;
+    int crossing_count = 0;
+
+    for (uint32_t i = 0; i < path->num_points && crossing_count < (int)ARRAY_LENGTH(crossings); ++i)
+    {
+      GPoint a = path->points[i];
+      GPoint b = path->points[(i + 1) % path->num_points];
+      float ay = a.y + path->offset.y;
+      float by = b.y + path->offset.y;
+
+      if ((ay <= sample_y && by > sample_y) || (by <= sample_y && ay > sample_y))
+      {
+        float t = (sample_y - ay) / (by - ay);
+        float x = a.x + path->offset.x + t * (b.x - a.x);
+        crossings[crossing_count++] = (int)floorf(x + 0.5f);
+      }
+    }
+
+    qsort(crossings, crossing_count, sizeof(int), compare_int);
+    for (int i = 0; i + 1 < crossing_count; i += 2)
+    {
+      for (int x = crossings[i]; x < crossings[i + 1]; ++x)
+      {
+        context_put_pixel(ctx, x, y, ctx->fill_color);
+      }
+    }
+  }
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1)
+{
+  int x0 = p0.x;
+  int y0 = p0.y;
+  int dx = abs(p1.x - p0.x);
+  int dy = -abs(p1.y - p0.y);
+  int sx = p0.x < p1.x ? 1 : -1;
+  int sy = p0.y < p1.y ? 1 : -1;
+  int err = dx + dy;
+
+  s_stats.line_calls++;
+  for (;;)
+  {
+    context_put_pixel(ctx, x0, y0, ctx->stroke_color);
+    if (x0 == p1.x && y0 == p1.y)
+    {
+      break;
+    }
+
+    int e2 = 2 * err;
+    if (e2 >= dy)
+    {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx)
+    {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask)
+{
+  s_stats.rect_calls++;
+  for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; ++y)
+  {
+    for (int x = rect.origin.x; x < rect.origin.x + rect.size.w; ++x)
+    {
+      context_put_pixel(ctx, x, y, ctx->fill_color);
+    }
+  }
+}
+
+static uint8_t blend_channel(uint8_t src, uint8_t dst, uint8_t alpha)
+{
+  return (uint8_t)((src * alpha + dst * (3 - alpha) + 1) / 3);
+}
+
+// Source pixel after the context's compositing mode, or false to leave the
+// destination alone. 1-bit sources follow the SDK mask semantics, 8-bit
+// sources are copied (GCompOpAssign) or alpha blended (GCompOpSet).
+static bool composite_pixel(const GContext *ctx, bool one_bit_source, GColor src, GColor dst, GColor *out_color)
+{
+  if (!one_bit_source)
+  {
+    if (ctx->compositing_mode != GCompOpSet || src.a == 3)
+    {
+      *out_color = src;
+      return true;
+    }
+
+    if (src.a == 0)
+    {
+      return false;
+    }
+
+    out_color->argb = 0xC0;
+    out_color->r = blend_channel(src.r, dst.r, src.a);
+    out_color->g = blend_channel(src.g, dst.g, src.a);
+    out_color->b = blend_channel(src.b, dst.b, src.a);
+    return true;
+  }
+
+  const bool white = gcolor_equal(src, GColorWhite);
+
+  switch (ctx->compositing_mode)
+  {
+    case GCompOpAssign:
+      *out_color = src;
+      return true;
+    case GCompOpAssignInverted:
+      *out_color = white ? GColorBlack : GColorWhite;
+      return true;
+    case GCompOpOr:
+      *out_color = GColorWhite;
+      return white;
+    case GCompOpAnd:
+      *out_color = GColorBlack;
+      return !white;
+    case GCompOpClear:
+      *out_color = GColorBlack;
+      return white;
+    case GCompOpSet:
+      *out_color = GColorWhite;
+      return !white;
+  }
+
+  return false;
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect)
+{
+  const bool one_bit_source = bitmap->format == GBitmapFormat1Bit;
+
+  s_stats.bitmap_calls++;
+  for (int y = 0; y < rect.size.h && y < bitmap->size.h; ++y)
+  {
+    for (int x = 0; x < rect.size.w && x < bitmap->size.w; ++x)
+    {
+      const int screen_x = rect.origin.x + x + ctx->offset.x;
+      const int screen_y = rect.origin.y + y + ctx->offset.y;
+      GColor dst = GColorBlack;
+      GColor color;
+
+      if (screen_x >= 0 && screen_y >= 0 && screen_x < s_screen->size.w && screen_y < s_screen->size.h)
+      {
+        dst = bitmap_get_pixel(s_screen, screen_x, screen_y);
+      }
+
+      if (composite_pixel(ctx, one_bit_source, bitmap_get_pixel(bitmap, x, y), dst, &color))
+      {
+        context_put_pixel(ctx, rect.origin.x + x, rect.origin.y + y, color);
+      }
+    }
+  }
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx)
+{
+  if (ctx->framebuffer_captured)
+  {
+    return NULL;
+  }
+
+  s_stats.framebuffer_captures++;
+  ctx->framebuffer_captured = true;
+  return s_screen;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer)
+{
+  if (!ctx->framebuffer_captured || buffer != s_screen)
+  {
+    return false;
+  }
+
+  ctx->framebuffer_captured = false;
+  return true;
+}
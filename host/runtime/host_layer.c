@@ -0,0 +1,248 @@
+#include "host_private.h"
+
+struct Layer
+{
+  GRect frame;
+  GRect bounds;
+  Layer *parent;
+  Layer *first_child;
+  Layer *next_sibling;
+  LayerUpdateProc update_proc;
+  bool hidden;
+  size_t data_size;
+  uint8_t data[];
+};
+
+static Layer *s_root_layer;
+static GColor s_background_color;
+static bool s_render_pending;
+
+//==============================================================================
+// layers
+
+Layer *layer_create_with_data(GRect frame, size_t data_size)
+{
+  Layer *layer = calloc(1, sizeof(Layer) + data_size);
+
+  host_stats_mutable()->heap_allocations++;
+  if (layer == NULL)
+  {
+    return NULL;
+  }
+
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+  layer->data_size = data_size;
+  return layer;
+}
+
+Layer *layer_create(GRect frame)
+{
+  return layer_create_with_data(frame, 0);
+}
+
+void layer_destroy(Layer *layer)
+{
+  if (layer == NULL)
+  {
+    return;
+  }
+
+  layer_remove_from_parent(layer);
+  while (layer->first_child != NULL)
+  {
+    layer_remove_from_parent(layer->first_child);
+  }
+  host_stats_mutable()->heap_frees++;
+  free(layer);
+}
+
+void *layer_get_data(const Layer *layer)
+{
+  return layer->data_size > 0 ? (void *)layer->data : NULL;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc)
+{
+  layer->update_proc = update_proc;
+}
+
+void layer_mark_dirty(Layer *layer)
+{
+  s_render_pending = true;
+}
+
+GRect layer_get_frame(const Layer *layer)
+{
+  return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame)
+{
+  bool size_changed = frame.size.w != layer->frame.size.w || frame.size.h != layer->frame.size.h;
+
+  layer->frame = frame;
+  if (size_changed)
+  {
+    layer->bounds.size = frame.size;
+  }
+  s_render_pending = true;
+}
+
+GRect layer_get_bounds(const Layer *layer)
+{
+  return layer->bounds;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds)
+{
+  layer->bounds = bounds;
+  s_render_pending = true;
+}
+
+void layer_add_child(Layer *parent, Layer *child)
+{
+  Layer **link = &parent->first_child;
+
+  layer_remove_from_parent(child);
+  while (*link != NULL)
+  {
+    link = &(*link)->next_sibling;
+  }
+
+  *link = child;
+  child->parent = parent;
+  s_render_pending = true;
+}
+
+void layer_remove_from_parent(Layer *child)
+{
+  Layer **link;
+
+  if (child->parent == NULL)
+  {
+    return;
+  }
+
+  link = &child->parent->first_child;
+  while (*link != NULL && *link != child)
+  {
+    link = &(*link)->next_sibling;
+  }
+
+  if (*link == child)
+  {
+    *link = child->next_sibling;
+  }
+
+  child->parent = NULL;
+  child->next_sibling = NULL;
+  s_render_pending = true;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden)
+{
+  layer->hidden = hidden;
+  s_render_pending = true;
+}
+
+bool layer_get_hidden(const Layer *layer)
+{
+  return layer->hidden;
+}
+
+//==============================================================================
+// screen / rendering
+
+void host_screen_init(GSize size)
+{
+  host_screen_create_bitmap(size);
+  s_root_layer = layer_create(GRect(0, 0, size.w, size.h));
+  s_background_color = GColorBlack;
+  s_render_pending = true;
+}
+
+void host_screen_deinit(void)
+{
+  layer_destroy(s_root_layer);
+  s_root_layer = NULL;
+  host_screen_destroy_bitmap();
+}
+
+GSize host_screen_get_size(void)
+{
+  return s_root_layer->frame.size;
+}
+
+Layer *host_screen_get_root_layer(void)
+{
+  return s_root_layer;
+}
+
+void host_screen_set_background_color(GColor color)
+{
+  s_background_color = color;
+  s_render_pending = true;
+}
+
+static GRect intersect_rect(GRect a, GRect b)
+{
+  int x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+  int y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+  int x1 = a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+  int y1 = a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+
+  return GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+static void render_layer_tree(Layer *layer, GPoint parent_origin, GRect parent_clip)
+{
+  GPoint origin;
+  GRect clip;
+
+  if (layer->hidden)
+  {
+    return;
+  }
+
+  origin = GPoint(parent_origin.x + layer->frame.origin.x, parent_origin.y + layer->frame.origin.y);
+  clip = intersect_rect(parent_clip, GRect(origin.x, origin.y, layer->frame.size.w, layer->frame.size.h));
+  origin.x += layer->bounds.origin.x;
+  origin.y += layer->bounds.origin.y;
+
+  if (layer->update_proc != NULL)
+  {
+    host_stats_mutable()->layer_updates++;
+    layer->update_proc(layer, host_context_begin(clip, origin));
+  }
+
+  for (Layer *child = layer->first_child; child != NULL; child = child->next_sibling)
+  {
+    render_layer_tree(child, origin, clip);
+  }
+}
+
+void host_render_layer(Layer *layer)
+{
+  GPoint origin = GPointZero;
+
+  for (Layer *parent = layer->parent; parent != NULL; parent = parent->parent)
+  {
+    origin.x += parent->frame.origin.x + parent->bounds.origin.x;
+    origin.y += parent->frame.origin.y + parent->bounds.origin.y;
+  }
+
+  render_layer_tree(layer, origin, s_root_layer->frame);
+}
+
+void host_render(void)
+{
+  host_screen_clear(s_background_color);
+  render_layer_tree(s_root_layer, GPointZero, s_root_layer->frame);
+  s_render_pending = false;
+}
+
+bool host_render_pending(void)
+{
+  return s_render_pending;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "pebble_host.h"
+
+struct GContext
+{
+  GColor fill_color;
+  GColor stroke_color;
+  bool antialiased;
+  GCompOp compositing_mode;
+  bool framebuffer_captured;
+  GRect clip;
+  GPoint offset;
+};
+
+void host_screen_create_bitmap(GSize size);
+void host_screen_destroy_bitmap(void);
+void host_screen_clear(GColor color);
+GContext *host_context_begin(GRect clip, GPoint offset);
+HostStats *host_stats_mutable(void);
+void host_animations_step(uint32_t now_ms);
+void host_timers_step(uint32_t now_ms);
@@ -0,0 +1,754 @@
+#include <malloc.h>
+#include <math.h>
+#include <stdarg.h>
+#include "host_private.h"
+
+//==============================================================================
+// logging
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+{
+  va_list args;
+  const char *name = strrchr(src_filename, '/');
+
+  fprintf(stderr, "[%u] %s:%d> ", log_level, name != NULL ? name + 1 : src_filename, src_line_number);
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+//==============================================================================
+// clock / timers
+
+#define HOST_TIMER_MAX 8
+
+struct AppTimer
+{
+  bool active;
+  uint32_t fire_ms;
+  AppTimerCallback callback;
+  void *data;
+};
+
+static uint32_t s_now_ms;
+static AppTimer s_timers[HOST_TIMER_MAX];
+
+uint32_t host_clock_get_ms(void)
+{
+  return s_now_ms;
+}
+
+void host_clock_advance(uint32_t ms)
+{
+  s_now_ms += ms;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms)
+{
+  if (tloc != NULL)
+  {
+    *tloc = (time_t)(s_now_ms / 1000);
+  }
+
+  if (out_ms != NULL)
+  {
+    *out_ms = (uint16_t)(s_now_ms % 1000);
+  }
+
+  return (uint16_t)(s_now_ms % 1000);
+}
+
+bool clock_is_24h_style(void)
+{
+  return true;
+}
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data)
+{
+  host_stats_mutable()->heap_allocations++;
+  for (int i = 0; i < HOST_TIMER_MAX; ++i)
+  {
+    if (!s_timers[i].active)
+    {
+      s_timers[i].active = true;
+      s_timers[i].fire_ms = s_now_ms + timeout_ms;
+      s_timers[i].callback = callback;
+      s_timers[i].data = callback_data;
+      return &s_timers[i];
+    }
+  }
+
+  return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms)
+{
+  if (timer == NULL || !timer->active)
+  {
+    return false;
+  }
+
+  timer->fire_ms = s_now_ms + new_timeout_ms;
+  return true;
+}
+
+void app_timer_cancel(AppTimer *timer)
+{
+  if (timer != NULL && timer->active)
+  {
+    timer->active = false;
+    host_stats_mutable()->heap_frees++;
+  }
+}
+
+void host_timers_step(uint32_t now_ms)
+{
+  for (int i = 0; i < HOST_TIMER_MAX; ++i)
+  {
+    if (s_timers[i].active && s_timers[i].fire_ms <= now_ms)
+    {
+      s_timers[i].active = false;
+      host_stats_mutable()->heap_frees++;
+      s_timers[i].callback(s_timers[i].data);
+    }
+  }
+}
+
+//==============================================================================
+// animation
+
+#define HOST_ANIMATION_MAX 8
+
+struct Animation
+{
+  bool allocated;
+  bool scheduled;
+  uint32_t delay_ms;
+  uint32_t duration_ms;
+  uint32_t start_ms;
+  const AnimationImplementation *implementation;
+  AnimationHandlers handlers;
+  void *context;
+};
+
+static Animation s_animations[HOST_ANIMATION_MAX];
+
+// SDK 3 frees an animation once its stopped handler returns; touching it after
+// that is a use-after-free on the watch, so it aborts here.
+static void check_allocated(const Animation *animation, const char *function)
+{
+  if (!animation->allocated)
+  {
+    fprintf(stderr, "%s: animation was already freed\n", function);
+    abort();
+  }
+}
+
+static void release(Animation *animation)
+{
+  animation->allocated = false;
+  animation->scheduled = false;
+  host_stats_mutable()->heap_frees++;
+}
+
+static void stop(Animation *animation, bool finished)
+{
+  animation->scheduled = false;
+  if (animation->handlers.stopped != NULL)
+  {
+    animation->handlers.stopped(animation, finished, animation->context);
+  }
+  release(animation);
+}
+
+Animation *animation_create(void)
+{
+  host_stats_mutable()->heap_allocations++;
+  for (int i = 0; i < HOST_ANIMATION_MAX; ++i)
+  {
+    if (!s_animations[i].allocated)
+    {
+      memset(&s_animations[i], 0, sizeof(Animation));
+      s_animations[i].allocated = true;
+      s_animations[i].duration_ms = 250;
+      return &s_animations[i];
+    }
+  }
+
+  return NULL;
+}
+
+bool animation_destroy(Animation *animation)
+{
+  if (animation == NULL)
+  {
+    return false;
+  }
+
+  check_allocated(animation, "animation_destroy");
+  release(animation);
+  return true;
+}
+
+bool animation_set_delay(Animation *animation, uint32_t delay_ms)
+{
+  check_allocated(animation, "animation_set_delay");
+  animation->delay_ms = delay_ms;
+  return true;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms)
+{
+  check_allocated(animation, "animation_set_duration");
+  animation->duration_ms = duration_ms;
+  return true;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation)
+{
+  check_allocated(animation, "animation_set_implementation");
+  animation->implementation = implementation;
+  return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context)
+{
+  check_allocated(animation, "animation_set_handlers");
+  animation->handlers = callbacks;
+  animation->context = context;
+  return true;
+}
+
+void *animation_get_context(Animation *animation)
+{
+  return animation->context;
+}
+
+bool animation_schedule(Animation *animation)
+{
+  check_allocated(animation, "animation_schedule");
+  animation->scheduled = true;
+  animation->start_ms = s_now_ms + animation->delay_ms;
+  return true;
+}
+
+bool animation_unschedule(Animation *animation)
+{
+  check_allocated(animation, "animation_unschedule");
+  if (!animation->scheduled)
+  {
+    return false;
+  }
+
+  stop(animation, false);
+  return true;
+}
+
+bool animation_is_scheduled(Animation *animation)
+{
+  check_allocated(animation, "animation_is_scheduled");
+  return animation->scheduled;
+}
+
+void host_animations_step(uint32_t now_ms)
+{
+  for (int i = 0; i < HOST_ANIMATION_MAX; ++i)
+  {
+    Animation *animation = &s_animations[i];
+    AnimationProgress progress;
+
+    if (!animation->allocated || !animation->scheduled || now_ms < animation->start_ms)
+    {
+      continue;
+    }
+
+    if (now_ms >= animation->start_ms + animation->duration_ms)
+    {
+      progress = ANIMATION_NORMALIZED_MAX;
+    }
+    else
+    {
+      progress = (AnimationProgress)(((uint64_t)(now_ms - animation->start_ms) * ANIMATION_NORMALIZED_MAX) /
+        animation->duration_ms);
+    }
+
+    if (animation->implementation != NULL && animation->implementation->update != NULL)
+    {
+      animation->implementation->update(animation, progress);
+    }
+
+    if (progress == ANIMATION_NORMALIZED_MAX)
+    {
+      stop(animation, true);
+    }
+  }
+}
+
+bool host_animations_active(void)
+{
+  for (int i = 0; i < HOST_ANIMATION_MAX; ++i)
+  {
+    if (s_animations[i].allocated && s_animations[i].scheduled)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void host_run_for(uint32_t ms, uint32_t frame_ms)
+{
+  uint32_t end_ms = s_now_ms + ms;
+
+  while (s_now_ms < end_ms)
+  {
+    s_now_ms += frame_ms;
+    host_timers_step(s_now_ms);
+    host_animations_step(s_now_ms);
+    if (host_render_pending())
+    {
+      host_render();
+    }
+  }
+}
+
+//==============================================================================
+// trig / battery / memory
+
+int32_t sin_lookup(int32_t angle)
+{
+  return (int32_t)lround(sin(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle)
+{
+  return (int32_t)lround(cos(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+static BatteryChargeState s_battery = { 100, false, false };
+
+BatteryChargeState battery_state_service_peek(void)
+{
+  return s_battery;
+}
+
+void host_battery_set(uint8_t charge_percent, bool is_charging)
+{
+  s_battery.charge_percent = charge_percent;
+  s_battery.is_charging = is_charging;
+  s_battery.is_plugged = is_charging;
+}
+
+size_t heap_bytes_used(void)
+{
+  return mallinfo2().uordblks;
+}
+
+size_t heap_bytes_free(void)
+{
+  return mallinfo2().fordblks;
+}
+
+//==============================================================================
+// persistent storage
+
+#define HOST_PERSIST_MAX 32
+
+typedef struct PersistEntry
+{
+  bool used;
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static PersistEntry s_persist[HOST_PERSIST_MAX];
+static uint32_t s_persist_writes;
+
+static PersistEntry *persist_find(uint32_t key, bool create)
+{
+  PersistEntry *free_entry = NULL;
+
+  for (int i = 0; i < HOST_PERSIST_MAX; ++i)
+  {
+    if (s_persist[i].used && s_persist[i].key == key)
+    {
+      return &s_persist[i];
+    }
+
+    if (!s_persist[i].used && free_entry == NULL)
+    {
+      free_entry = &s_persist[i];
+    }
+  }
+
+  if (create && free_entry != NULL)
+  {
+    free_entry->used = true;
+    free_entry->key = key;
+    free_entry->size = 0;
+    return free_entry;
+  }
+
+  return NULL;
+}
+
+bool persist_exists(const uint32_t key)
+{
+  return persist_find(key, false) != NULL;
+}
+
+int persist_get_size(const uint32_t key)
+{
+  PersistEntry *entry = persist_find(key, false);
+  return entry != NULL ? entry->size : -1;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size)
+{
+  PersistEntry *entry = persist_find(key, false);
+  size_t size;
+
+  if (entry == NULL)
+  {
+    return -1;
+  }
+
+  size = entry->size < buffer_size ? entry->size : buffer_size;
+  memcpy(buffer, entry->data, size);
+  return (int)size;
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size)
+{
+  PersistEntry *entry = persist_find(key, true);
+  size_t length = size < PERSIST_DATA_MAX_LENGTH ? size : PERSIST_DATA_MAX_LENGTH;
+
+  if (entry == NULL)
+  {
+    return -1;
+  }
+
+  memcpy(entry->data, data, length);
+  entry->size = (uint16_t)length;
+  s_persist_writes++;
+  return (int)length;
+}
+
+bool persist_read_bool(const uint32_t key)
+{
+  bool value = false;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+int32_t persist_read_int(const uint32_t key)
+{
+  int32_t value = 0;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+int persist_write_bool(const uint32_t key, const bool value)
+{
+  return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_write_int(const uint32_t key, const int32_t value)
+{
+  return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_delete(const uint32_t key)
+{
+  PersistEntry *entry = persist_find(key, false);
+
+  if (entry == NULL)
+  {
+    return -1;
+  }
+
+  entry->used = false;
+  s_persist_writes++;
+  return 0;
+}
+
+void host_persist_reset(void)
+{
+  memset(s_persist, 0, sizeof(s_persist));
+  s_persist_writes = 0;
+}
+
+uint32_t host_persist_write_count(void)
+{
+  return s_persist_writes;
+}
+
+//==============================================================================
+// resources
+
+#define HOST_RESOURCE_MAX 4
+
+typedef struct HostResource
+{
+  uint32_t id;
+  uint8_t *data;
+  size_t size;
+} HostResource;
+
+static HostResource s_resources[HOST_RESOURCE_MAX];
+
+bool host_resource_load(uint32_t resource_id, const char *path)
+{
+  HostResource *resource = NULL;
+  FILE *file;
+  long size;
+
+  for (int i = 0; i < HOST_RESOURCE_MAX && resource == NULL; ++i)
+  {
+    if (s_resources[i].data == NULL || s_resources[i].id == resource_id)
+    {
+      resource = &s_resources[i];
+    }
+  }
+
+  file = fopen(path, "rb");
+  if (resource == NULL || file == NULL)
+  {
+    if (file != NULL)
+    {
+      fclose(file);
+    }
+    return false;
+  }
+
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  free(resource->data);
+  resource->id = resource_id;
+  resource->size = size > 0 ? (size_t)size : 0;
+  resource->data = malloc(resource->size > 0 ? resource->size : 1);
+  if (resource->data == NULL || fread(resource->data, 1, resource->size, file) != resource->size)
+  {
+    free(resource->data);
+    resource->data = NULL;
+    fclose(file);
+    return false;
+  }
+
+  fclose(file);
+  return true;
+}
+
+ResHandle resource_get_handle(uint32_t resource_id)
+{
+  for (int i = 0; i < HOST_RESOURCE_MAX; ++i)
+  {
+    if (s_resources[i].data != NULL && s_resources[i].id == resource_id)
+    {
+      return &s_resources[i];
+    }
+  }
+
+  return NULL;
+}
+
+size_t resource_size(ResHandle h)
+{
+  return h != NULL ? ((const HostResource *)h)->size : 0;
+}
+
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes)
+{
+  const HostResource *resource = h;
+
+  if (resource == NULL || start_offset >= resource->size)
+  {
+    return 0;
+  }
+
+  if (num_bytes > resource->size - start_offset)
+  {
+    num_bytes = resource->size - start_offset;
+  }
+
+  memcpy(buffer, resource->data + start_offset, num_bytes);
+  return num_bytes;
+}
+
+//==============================================================================
+// dictionary / app message
+
+typedef struct __attribute__((__packed__)) DictHeader
+{
+  uint8_t count;
+} DictHeader;
+
+static Tuple *next_tuple(Tuple *tuple)
+{
+  return (Tuple *)((uint8_t *)tuple + sizeof(Tuple) + tuple->length);
+}
+
+Tuple *dict_read_first(DictionaryIterator *iter)
+{
+  iter->cursor = (Tuple *)(iter->dictionary + sizeof(DictHeader));
+  return (const uint8_t *)iter->cursor < iter->end ? iter->cursor : NULL;
+}
+
+Tuple *dict_read_next(DictionaryIterator *iter)
+{
+  if (iter->cursor == NULL || (const uint8_t *)iter->cursor >= iter->end)
+  {
+    return NULL;
+  }
+
+  iter->cursor = next_tuple(iter->cursor);
+  return (const uint8_t *)iter->cursor < iter->end ? iter->cursor : NULL;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key)
+{
+  Tuple *tuple = (Tuple *)(iter->dictionary + sizeof(DictHeader));
+
+  while ((const uint8_t *)tuple < iter->end)
+  {
+    if (tuple->key == key)
+    {
+      return tuple;
+    }
+    tuple = next_tuple(tuple);
+  }
+
+  return NULL;
+}
+
+static size_t s_dict_capacity;
+
+void host_dict_begin(uint8_t *buffer, size_t size, DictionaryIterator *iter)
+{
+  memset(buffer, 0, size);
+  s_dict_capacity = size;
+  iter->dictionary = buffer;
+  iter->end = buffer + sizeof(DictHeader);
+  iter->cursor = (Tuple *)iter->end;
+}
+
+static Tuple *dict_append(DictionaryIterator *iter, uint32_t key, TupleType type, uint16_t length)
+{
+  Tuple *tuple = (Tuple *)iter->end;
+
+  if ((size_t)(iter->end - iter->dictionary) + sizeof(Tuple) + length > s_dict_capacity)
+  {
+    return NULL;
+  }
+
+  tuple->key = key;
+  tuple->type = type;
+  tuple->length = length;
+  iter->end = (const uint8_t *)tuple + sizeof(Tuple) + length;
+  ((DictHeader *)iter->dictionary)->count++;
+  return tuple;
+}
+
+void host_dict_add_int32(DictionaryIterator *iter, uint32_t key, int32_t value)
+{
+  Tuple *tuple = dict_append(iter, key, TUPLE_INT, sizeof(int32_t));
+
+  if (tuple != NULL)
+  {
+    memcpy(tuple->value->data, &value, sizeof(value));
+  }
+}
+
+void host_dict_add_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t size)
+{
+  Tuple *tuple = dict_append(iter, key, TUPLE_BYTE_ARRAY, size);
+
+  if (tuple != NULL)
+  {
+    memcpy(tuple->value->data, data, size);
+  }
+}
+
+void host_dict_end(DictionaryIterator *iter)
+{
+  iter->cursor = NULL;
+}
+
+int dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed)
+{
+  Tuple *tuple = dict_append(iter, key, is_signed ? TUPLE_INT : TUPLE_UINT, width_bytes);
+
+  if (tuple == NULL)
+  {
+    return APP_MSG_BUFFER_OVERFLOW;
+  }
+
+  memcpy(tuple->value->data, integer, width_bytes);
+  return APP_MSG_OK;
+}
+
+int dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size)
+{
+  Tuple *tuple = dict_append(iter, key, TUPLE_BYTE_ARRAY, size);
+
+  if (tuple == NULL)
+  {
+    return APP_MSG_BUFFER_OVERFLOW;
+  }
+
+  memcpy(tuple->value->data, data, size);
+  return APP_MSG_OK;
+}
+
+static AppMessageInboxReceived s_inbox_received;
+static uint8_t s_outbox_buffer[512];
+static DictionaryIterator s_outbox;
+static DictionaryIterator s_last_sent;
+static uint8_t s_last_sent_buffer[512];
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound)
+{
+  return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback)
+{
+  AppMessageInboxReceived previous = s_inbox_received;
+  s_inbox_received = received_callback;
+  return previous;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator)
+{
+  host_dict_begin(s_outbox_buffer, sizeof(s_outbox_buffer), &s_outbox);
+  *iterator = &s_outbox;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void)
+{
+  size_t size = (size_t)(s_outbox.end - s_outbox.dictionary);
+
+  memcpy(s_last_sent_buffer, s_outbox_buffer, size);
+  s_last_sent.dictionary = s_last_sent_buffer;
+  s_last_sent.end = s_last_sent_buffer + size;
+  s_last_sent.cursor = NULL;
+  return APP_MSG_OK;
+}
+
+DictionaryIterator *host_app_message_last_sent(void)
+{
+  return s_last_sent.dictionary != NULL ? &s_last_sent : NULL;
+}
+
+void host_app_message_deliver(DictionaryIterator *iter)
+{
+  if (s_inbox_received != NULL)
+  {
+    s_inbox_received(iter, NULL);
+  }
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <string.h>
+#include "pebble_host.h"
+#include "app_settings.h"
+
+//==============================================================================
+// Settings check, against the stand-in's persistent storage: the legacy keys
+// migrate into the blob and are deleted, loading and saving unchanged settings
+// writes nothing, a blob with a bad checksum loads the defaults, and a
+// SETTINGS_DELTA cut short changes nothing. A delta taken against other
+// settings than the watch holds is dropped and answered with the watch's
+// checksum, unless it carries every field. A delta colour of RGB 0x000001 is
+// kept as it is through the blob, not read as the legacy white.
+
+#define DELTA_VERSION 2
+#define DELTA_FLAGS (1 << 0)
+#define DELTA_BG_COLOR (1 << 1)
+#define DELTA_FACE_COLOR (1 << 2)
+#define DELTA_ALL ((1 << 6) - 1)
+
+static const AppSettings LEGACY_SETTINGS = {
+  .slow_version = true,
+  .bg_color = 0x123456,
+  .face_color = 0x00AA55,
+  .face_mix_with_background = true,
+  .line_color = 0xFF0000,
+  .line_mix_with_background = false,
+  .split_line_colors = true,
+  .back_line_color = 0x0000FF,
+  .side_line_color = 0x00FF00,
+};
+
+static int s_checks;
+static int s_failures;
+
+static void expect(bool condition, const char *what)
+{
+  ++s_checks;
+  if (!condition)
+  {
+    fprintf(stderr, "FAIL: %s\n", what);
+    ++s_failures;
+  }
+}
+
+static bool settings_equal(const AppSettings *a, const AppSettings *b)
+{
+  return a->slow_version == b->slow_version && a->bg_color == b->bg_color && a->face_color == b->face_color &&
+    a->face_mix_with_background == b->face_mix_with_background && a->line_color == b->line_color &&
+    a->line_mix_with_background == b->line_mix_with_background && a->split_line_colors == b->split_line_colors &&
+    a->back_line_color == b->back_line_color && a->side_line_color == b->side_line_color;
+}
+
+static void write_legacy_settings(const AppSettings *settings)
+{
+  persist_write_bool(PERSIST_KEY_SLOW_VERSION, settings->slow_version);
+  persist_write_int(PERSIST_KEY_BG_COLOR, settings->bg_color);
+  persist_write_int(PERSIST_KEY_FACE_COLOR, settings->face_color);
+  persist_write_bool(PERSIST_KEY_FACE_MIX_WITH_BACKGROUND, settings->face_mix_with_background);
+  persist_write_int(PERSIST_KEY_LINE_COLOR, settings->line_color);
+  persist_write_bool(PERSIST_KEY_LINE_MIX_WITH_BACKGROUND, settings->line_mix_with_background);
+  persist_write_bool(PERSIST_KEY_SPLIT_LINE_COLORS, settings->split_line_colors);
+  persist_write_int(PERSIST_KEY_BACK_LINE_COLOR, settings->back_line_color);
+  persist_write_int(PERSIST_KEY_SIDE_LINE_COLOR, settings->side_line_color);
+}
+
+static bool legacy_keys_exist(void)
+{
+  for (uint32_t key = PERSIST_KEY_SLOW_VERSION; key <= PERSIST_KEY_SIDE_LINE_COLOR; ++key)
+  {
+    if (persist_exists(key))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Delivers one SETTINGS_DELTA of length bytes, taken against base (its
+// checksum goes into the header); true when it changed settings.
+static bool apply_delta(AppSettings *settings, const AppSettings *base, const uint8_t *delta, uint16_t length)
+{
+  const uint16_t checksum = app_settings_checksum(base);
+  uint8_t bytes[32];
+  uint8_t buffer[64];
+  DictionaryIterator iterator;
+
+  memcpy(bytes, delta, length);
+  bytes[1] = checksum >> 8;
+  bytes[2] = checksum & 0xFF;
+  host_dict_begin(buffer, sizeof(buffer), &iterator);
+  host_dict_add_data(&iterator, MESSAGE_KEY_SETTINGS_DELTA, bytes, length);
+  host_dict_end(&iterator);
+  return app_settings_apply_message(settings, &iterator);
+}
+
+// The SETTINGS_CHECKSUM the watch sent back, or -1.
+static int32_t reported_checksum(void)
+{
+  DictionaryIterator *reply = host_app_message_last_sent();
+  const Tuple *tuple = reply != NULL ? dict_find(reply, MESSAGE_KEY_SETTINGS_CHECKSUM) : NULL;
+
+  return tuple != NULL ? tuple->value->uint16 : -1;
+}
+
+int main(void)
+{
+  // the checksum bytes are filled in by apply_delta()
+  static const uint8_t DELTA[] = {
+    DELTA_VERSION, 0, 0, DELTA_FLAGS | DELTA_BG_COLOR | DELTA_FACE_COLOR, 0, 0x20, 0x40, 0x60, 0x80, 0xA0, 0xC0,
+  };
+  static const uint8_t FULL_DELTA[] = {
+    DELTA_VERSION, 0, 0, DELTA_ALL, 0, 0x11, 0x11, 0x11, 0x22, 0x22, 0x22, 0x33, 0x33, 0x33, 0x44, 0x44, 0x44,
+    0x55, 0x55, 0x55,
+  };
+  static const uint8_t NEAR_BLACK_DELTA[] = { DELTA_VERSION, 0, 0, DELTA_BG_COLOR, 0x00, 0x00, 0x01 };
+  AppSettings defaults;
+  AppSettings settings;
+  AppSettings before;
+  uint8_t blob[64];
+  int blob_size;
+  uint32_t writes;
+
+  host_persist_reset();
+  app_settings_load(&defaults);
+  expect(host_persist_write_count() == 0, "loading the defaults wrote to storage");
+
+  // migration
+  host_persist_reset();
+  write_legacy_settings(&LEGACY_SETTINGS);
+  app_settings_load(&settings);
+  expect(settings_equal(&settings, &LEGACY_SETTINGS), "the legacy keys did not migrate");
+  expect(persist_exists(PERSIST_KEY_SETTINGS), "migration did not write the blob");
+  expect(!legacy_keys_exist(), "migration left legacy keys behind");
+
+  // unchanged settings, next launch
+  writes = host_persist_write_count();
+  app_settings_load(&settings);
+  app_settings_save(&settings);
+  expect(settings_equal(&settings, &LEGACY_SETTINGS), "the blob did not load the migrated settings");
+  expect(host_persist_write_count() == writes, "loading and saving unchanged settings wrote to storage");
+
+  // truncated and complete deltas
+  before = settings;
+  expect(!apply_delta(&settings, &settings, DELTA, sizeof(DELTA) - 1), "a truncated delta was accepted");
+  expect(settings_equal(&settings, &before), "a truncated delta changed the settings");
+  expect(apply_delta(&settings, &settings, DELTA, sizeof(DELTA)), "the complete delta was rejected");
+  expect(settings.bg_color == 0x204060 && settings.face_color == 0x80A0C0 && !settings.slow_version,
+    "the complete delta did not set every field it carries");
+
+  // deltas taken against other settings, as after a reinstall
+  before = settings;
+  expect(!apply_delta(&settings, &defaults, NEAR_BLACK_DELTA, sizeof(NEAR_BLACK_DELTA)) &&
+    settings_equal(&settings, &before), "a delta against other settings was applied");
+  expect(reported_checksum() == app_settings_checksum(&settings),
+    "a delta against other settings was not answered with the watch's checksum");
+  expect(apply_delta(&settings, &defaults, FULL_DELTA, sizeof(FULL_DELTA)) && settings.bg_color == 0x111111 &&
+    settings.side_line_color == 0x555555, "a delta with every field was not applied over other settings");
+
+  // a colour that was once the legacy white
+  expect(apply_delta(&settings, &settings, NEAR_BLACK_DELTA, sizeof(NEAR_BLACK_DELTA)) &&
+    settings.bg_color == 0x000001, "a delta colour of 0x000001 was not applied exactly");
+  app_settings_save(&settings);
+  app_settings_load(&settings);
+  expect(settings.bg_color == 0x000001, "a colour of 0x000001 did not reload exactly");
+
+  // corrupted blob
+  blob_size = persist_read_data(PERSIST_KEY_SETTINGS, blob, sizeof(blob));
+  blob[blob_size - 1] ^= 0x01;
+  persist_write_data(PERSIST_KEY_SETTINGS, blob, blob_size);
+  app_settings_load(&settings);
+  expect(settings_equal(&settings, &defaults), "a blob with a bad checksum did not load the defaults");
+
+  printf("%d of %d settings checks passed\n", s_checks - s_failures, s_checks);
+  return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+#!/usr/bin/env node
+
+// Compiles the digit outlines in config/digit-mesh.json into the packed tables
+// the renderer walks (src/c/digit_mesh.auto.h): int8 point coordinates, and
+// per digit a range of unique front edges, outline points (one side edge
+// each) and z = 10 cap polygons in shared index arrays, plus which side faces
+// look at the eye in each eye quadrant. Degenerate edges, edges already listed
+// (in either direction) and repeated or back-and-forth cap points are dropped.
+
+const fs = require('fs');
+const path = require('path');
+
+const repoRoot = path.resolve(__dirname, '..');
+const defaultSourcePath = path.join(repoRoot, 'config', 'digit-mesh.json');
+const defaultOutputPath = path.join(repoRoot, 'src', 'c', 'digit_mesh.auto.h');
+const QUADRANT_COUNT = 4;
+const MAX_EDGES = 16;
+
+//==============================================================================
+// sources
+
+function loadMeshSource(sourcePath) {
+  const source = JSON.parse(fs.readFileSync(sourcePath || defaultSourcePath, 'utf8'));
+
+  return {
+    points: source.points.map(([x, y]) => ({ x, y })),
+    digits: source.digits.map((digit) => ({ contours: digit.contours, solids: digit.solids }))
+  };
+}
+
+//==============================================================================
+// edges
+
+// Front edges in contour order, each kept in the direction it first appears.
+function uniqueContourEdges(contours) {
+  const seen = new Set();
+  const edges = [];
+
+  contours.forEach((contour) => {
+    contour.forEach((a, j) => {
+      const b = contour[(j + 1) % contour.length];
+      const key = a < b ? `${a}-${b}` : `${b}-${a}`;
+
+      if (a !== b && !seen.has(key)) {
+        seen.add(key);
+        edges.push([a, b]);
+      }
+    });
+  });
+
+  return edges;
+}
+
+function uniqueContourPoints(contours) {
+  return Array.from(new Set([].concat(...contours)));
+}
+
+// Drops repeated points and a -> b -> a spikes until the ring is stable; both
+// enclose no area.
+function simplifyRing(ring) {
+  let points = ring.slice();
+  let changed = true;
+
+  while (changed && points.length >= 3) {
+    changed = false;
+    for (let i = 0; i < points.length && points.length >= 3; ++i) {
+      const prev = points[(i + points.length - 1) % points.length];
+      const next = points[(i + 1) % points.length];
+
+      if (points[i] === next) {
+        points.splice(i, 1);
+        changed = true;
+      } else if (prev === next) {
+        points.splice(i, 2);
+        changed = true;
+      }
+    }
+  }
+
+  return points.length >= 3 ? points : [];
+}
+
+//==============================================================================
+// side face visibility
+
+// Even-odd test against the outline, in doubled model coordinates.
+function outlineContainsPoint(points, edges, x2, y2) {
+  let inside = false;
+
+  edges.forEach(([a, b]) => {
+    const pa = points[a];
+    const pb = points[b];
+
+    if ((pa.y * 2 > y2) !== (pb.y * 2 > y2) &&
+      x2 < pa.x * 2 + Math.trunc((pb.x - pa.x) * (y2 - pa.y * 2) / (pb.y - pa.y))) {
+      inside = !inside;
+    }
+  });
+
+  return inside;
+}
+
+// Outlines are axis-aligned and the eye stays in z = 1, so whether a side face
+// looks towards the eye depends only on the signs of the eye's x (quadrant
+// bit 0) and y (bit 1).
+function sideFaceMasks(points, edges) {
+  const masks = new Array(QUADRANT_COUNT).fill(0);
+
+  edges.forEach(([a, b], i) => {
+    const pa = points[a];
+    const pb = points[b];
+    let normalX = -Math.sign(pb.y - pa.y);
+    let normalY = Math.sign(pb.x - pa.x);
+
+    // Edge midpoints sit on grid lines, so one doubled unit off the edge is clear of the others.
+    if (outlineContainsPoint(points, edges, pa.x + pb.x + normalX, pa.y + pb.y + normalY)) {
+      normalX = -normalX;
+      normalY = -normalY;
+    }
+
+    for (let quadrant = 0; quadrant < QUADRANT_COUNT; ++quadrant) {
+      const eyeX = (quadrant & 1) ? -1 : 1;
+      const eyeY = (quadrant & 2) ? -1 : 1;
+
+      if (normalX * eyeX + normalY * eyeY > 0) {
+        masks[quadrant] |= 1 << i;
+      }
+    }
+  });
+
+  return masks;
+}
+
+function compileDigit(mesh, digit) {
+  const backOffset = mesh.points.length;
+  const edges = uniqueContourEdges(digit.contours);
+  const sidePoints = uniqueContourPoints(digit.contours);
+
+  if (edges.length > MAX_EDGES) {
+    throw new Error(`a digit outline has ${edges.length} edges, at most ${MAX_EDGES} fit the side face masks`);
+  }
+
+  return {
+    edges,
+    sidePoints,
+    caps: digit.solids.map(simplifyRing).filter((ring) => ring.length > 0)
+      .map((ring) => ring.map((index) => index + backOffset)),
+    visibleSideFaces: sideFaceMasks(mesh.points, edges),
+    pointMask: sidePoints.reduce((mask, index) => (mask | (1 << index)) >>> 0, 0)
+  };
+}
+
+function compileMesh(mesh) {
+  mesh.points.forEach((point) => {
+    if (point.x < -128 || point.x > 127 || point.y < -128 || point.y > 127) {
+      throw new Error(`point (${point.x}, ${point.y}) does not fit int8`);
+    }
+  });
+  if (mesh.points.length * 2 > 256 || mesh.points.length > 32) {
+    throw new Error(`${mesh.points.length} points do not fit the uint8 indices and the uint32 point mask`);
+  }
+
+  return { points: mesh.points, digits: mesh.digits.map((digit) => compileDigit(mesh, digit)) };
+}
+
+//==============================================================================
+// output
+
+function formatList(values) {
+  return values.join(', ');
+}
+
+function formatTable(type, name, rows) {
+  return `static const ${type} ${name}[] = {\n${rows.map((row) => `  ${row},`).join('\n')}\n};\n`;
+}
+
+function checkRange(name, value, max) {
+  if (value > max) {
+    throw new Error(`${name} needs ${value} entries, uint8 ranges address ${max}`);
+  }
+}
+
+function buildHeader(compiled) {
+  const digits = compiled.digits;
+  const pointCount = compiled.points.length;
+  const records = [];
+  const capStarts = [];
+  let edgeStart = 0;
+  let sideStart = 0;
+  let capPointStart = 0;
+
+  digits.forEach((digit) => {
+    records.push(`{ ${edgeStart}, ${digit.edges.length}, ${sideStart}, ${digit.sidePoints.length}, ` +
+      `${capStarts.length}, ${digit.caps.length}, ` +
+      `{ ${digit.visibleSideFaces.map((mask) => `0x${mask.toString(16).padStart(4, '0')}`).join(', ')} }, ` +
+      `0x${digit.pointMask.toString(16).padStart(8, '0')} }`);
+    digit.caps.forEach((cap) => {
+      capStarts.push(capPointStart);
+      capPointStart += cap.length;
+    });
+    edgeStart += digit.edges.length;
+    sideStart += digit.sidePoints.length;
+  });
+  capStarts.push(capPointStart);
+
+  checkRange('digit_mesh_edges', edgeStart, 255);
+  checkRange('digit_mesh_side_points', sideStart, 255);
+  checkRange('digit_mesh_cap_points', capPointStart, 255);
+
+  const maxCapPoints = Math.max(...digits.map((digit) => Math.max(...digit.caps.map((cap) => cap.length))));
+
+  return `#pragma once\n\n` +
+    `// Generated by scripts/compile-digit-mesh.js from config/digit-mesh.json.\n\n` +
+    `#define DIGIT_MESH_POINT_COUNT ${pointCount}\n` +
+    `#define DIGIT_MESH_DIGIT_COUNT ${digits.length}\n` +
+    `#define DIGIT_MESH_QUADRANT_COUNT ${QUADRANT_COUNT}\n` +
+    `#define DIGIT_MESH_MAX_CAP_POINTS ${maxCapPoints}\n\n` +
+    `// Ranges into the shared tables below.\n` +
+    `typedef struct DigitMesh\n` +
+    `{\n` +
+    `  // front edges, in pairs of digit_mesh_edges\n` +
+    `  uint8_t edge_start;\n` +
+    `  uint8_t edge_count;\n` +
+    `  // outline points in digit_mesh_side_points\n` +
+    `  uint8_t side_start;\n` +
+    `  uint8_t side_count;\n` +
+    `  // caps in digit_mesh_cap_starts\n` +
+    `  uint8_t cap_start;\n` +
+    `  uint8_t cap_count;\n` +
+    `  // per eye quadrant (bit 0: eye x < 0, bit 1: eye y < 0): bit k is set when the side face of\n` +
+    `  // edge k faces the eye\n` +
+    `  uint16_t visible_side_faces[DIGIT_MESH_QUADRANT_COUNT];\n` +
+    `  // points the outline uses\n` +
+    `  uint32_t point_mask;\n` +
+    `} DigitMesh;\n\n` +
+    `static const int8_t digit_mesh_point_x[DIGIT_MESH_POINT_COUNT] = { ` +
+    `${formatList(compiled.points.map((point) => point.x))} };\n` +
+    `static const int8_t digit_mesh_point_y[DIGIT_MESH_POINT_COUNT] = { ` +
+    `${formatList(compiled.points.map((point) => point.y))} };\n\n` +
+    `// Front edges as point index pairs; back edges are the same pairs offset by DIGIT_MESH_POINT_COUNT.\n` +
+    formatTable('uint8_t', 'digit_mesh_edges',
+      digits.map((digit) => digit.edges.map(([a, b]) => `${a}, ${b}`).join(',  '))) + '\n' +
+    `// Each outline point has a side edge to its back point, DIGIT_MESH_POINT_COUNT further on.\n` +
+    formatTable('uint8_t', 'digit_mesh_side_points', digits.map((digit) => formatList(digit.sidePoints))) + '\n' +
+    `// z = 10 cap polygons as back point indices; cap i spans cap_starts[i] .. cap_starts[i + 1].\n` +
+    formatTable('uint8_t', 'digit_mesh_cap_points',
+      digits.map((digit) => formatList([].concat(...digit.caps)))) +
+    `static const uint8_t digit_mesh_cap_starts[] = { ${formatList(capStarts)} };\n\n` +
+    formatTable('DigitMesh', 'digit_meshes', records);
+}
+
+//==============================================================================
+
+function parseArgs(argv) {
+  const args = { source: null, output: defaultOutputPath };
+
+  for (let i = 0; i < argv.length; ++i) {
+    if (argv[i] === '--source') {
+      args.source = argv[++i];
+    } else if (argv[i] === '--output') {
+      args.output = argv[++i];
+    } else {
+      throw new Error(`unknown argument: ${argv[i]}`);
+    }
+  }
+
+  return args;
+}
+
+function main() {
+  const args = parseArgs(process.argv.slice(2));
+
+  fs.writeFileSync(args.output, buildHeader(compileMesh(loadMeshSource(args.source))));
+  console.log(path.relative(repoRoot, args.output));
+}
+
+if (require.main === module) {
+  main();
+}
+
+module.exports = { loadMeshSource, compileMesh };
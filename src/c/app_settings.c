@@ -1,13 +1,53 @@
 #include "app_settings.h"
 #include "app_settings_defaults.auto.h"
 
-static int32_t sanitize_color_value(int32_t value, int32_t fallback)
+#define SETTINGS_BLOB_VERSION 1
+#define SETTINGS_DELTA_VERSION 2
+
+// The booleans, in the blob and in SETTINGS_DELTA.
+typedef enum SettingsFlag
 {
-  if (value == 0 || value == 1)
-  {
-    return value == 0 ? 0x000000 : 0xFFFFFF;
-  }
+  SETTINGS_FLAG_SLOW_VERSION = 1 << 0,
+  SETTINGS_FLAG_FACE_MIX_WITH_BACKGROUND = 1 << 1,
+  SETTINGS_FLAG_LINE_MIX_WITH_BACKGROUND = 1 << 2,
+  SETTINGS_FLAG_SPLIT_LINE_COLORS = 1 << 3,
+} SettingsFlag;
+
+// Which fields a SETTINGS_DELTA carries. It is the version, the checksum of
+// the settings it was taken against (2 bytes, high first), this mask, the
+// flags byte, then each colour as 3 bytes (r, g, b), in bit order.
+typedef enum SettingsDeltaField
+{
+  SETTINGS_DELTA_FLAGS = 1 << 0,
+  SETTINGS_DELTA_BG_COLOR = 1 << 1,
+  SETTINGS_DELTA_FACE_COLOR = 1 << 2,
+  SETTINGS_DELTA_LINE_COLOR = 1 << 3,
+  SETTINGS_DELTA_BACK_LINE_COLOR = 1 << 4,
+  SETTINGS_DELTA_SIDE_LINE_COLOR = 1 << 5,
+  SETTINGS_DELTA_ALL = (1 << 6) - 1,
+} SettingsDeltaField;
+
+#define SETTINGS_DELTA_HEADER_SIZE 4
 
+// PERSIST_KEY_SETTINGS; checksum covers every byte after it.
+typedef struct SettingsBlob
+{
+  uint8_t version;
+  uint8_t flags;
+  uint16_t checksum;
+  int32_t bg_color;
+  int32_t face_color;
+  int32_t line_color;
+  int32_t back_line_color;
+  int32_t side_line_color;
+} SettingsBlob;
+
+// what PERSIST_KEY_SETTINGS holds, so unchanged settings are not written again
+static SettingsBlob s_stored_blob;
+static bool s_has_stored_blob;
+
+static int32_t sanitize_color_value(int32_t value, int32_t fallback)
+{
   if (value < 0)
   {
     return fallback;
@@ -39,119 +79,293 @@ static void sanitize_settings(AppSettings *settings)
   settings->split_line_colors = settings->split_line_colors ? true : false;
 }
 
-void app_settings_load(AppSettings *settings)
+static uint16_t fletcher16(const uint8_t *bytes, size_t size)
+{
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    sum1 = (sum1 + bytes[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+
+  return (uint16_t)((sum2 << 8) | sum1);
+}
+
+static uint16_t blob_checksum(const SettingsBlob *blob)
+{
+  return fletcher16((const uint8_t *)blob + offsetof(SettingsBlob, bg_color),
+    sizeof(*blob) - offsetof(SettingsBlob, bg_color));
+}
+
+static uint8_t encode_flags(const AppSettings *settings)
+{
+  return (settings->slow_version ? SETTINGS_FLAG_SLOW_VERSION : 0) |
+    (settings->face_mix_with_background ? SETTINGS_FLAG_FACE_MIX_WITH_BACKGROUND : 0) |
+    (settings->line_mix_with_background ? SETTINGS_FLAG_LINE_MIX_WITH_BACKGROUND : 0) |
+    (settings->split_line_colors ? SETTINGS_FLAG_SPLIT_LINE_COLORS : 0);
+}
+
+static void decode_flags(AppSettings *settings, uint8_t flags)
 {
+  settings->slow_version = (flags & SETTINGS_FLAG_SLOW_VERSION) != 0;
+  settings->face_mix_with_background = (flags & SETTINGS_FLAG_FACE_MIX_WITH_BACKGROUND) != 0;
+  settings->line_mix_with_background = (flags & SETTINGS_FLAG_LINE_MIX_WITH_BACKGROUND) != 0;
+  settings->split_line_colors = (flags & SETTINGS_FLAG_SPLIT_LINE_COLORS) != 0;
+}
+
+uint16_t app_settings_checksum(const AppSettings *settings)
+{
+  const int32_t colors[] = {
+    settings->bg_color, settings->face_color, settings->line_color, settings->back_line_color,
+    settings->side_line_color,
+  };
+  uint8_t fields[1 + ARRAY_LENGTH(colors) * 3];
+
+  fields[0] = encode_flags(settings);
+  for (int i = 0; i < (int)ARRAY_LENGTH(colors); ++i)
+  {
+    fields[1 + i * 3] = (colors[i] >> 16) & 0xFF;
+    fields[2 + i * 3] = (colors[i] >> 8) & 0xFF;
+    fields[3 + i * 3] = colors[i] & 0xFF;
+  }
+
+  return fletcher16(fields, sizeof(fields));
+}
+
+static void encode_blob(SettingsBlob *out_blob, const AppSettings *settings)
+{
+  memset(out_blob, 0, sizeof(*out_blob));
+  out_blob->version = SETTINGS_BLOB_VERSION;
+  out_blob->flags = encode_flags(settings);
+  out_blob->bg_color = settings->bg_color;
+  out_blob->face_color = settings->face_color;
+  out_blob->line_color = settings->line_color;
+  out_blob->back_line_color = settings->back_line_color;
+  out_blob->side_line_color = settings->side_line_color;
+  out_blob->checksum = blob_checksum(out_blob);
+}
+
+static void decode_blob(AppSettings *settings, const SettingsBlob *blob)
+{
+  decode_flags(settings, blob->flags);
+  settings->bg_color = blob->bg_color;
+  settings->face_color = blob->face_color;
+  settings->line_color = blob->line_color;
+  settings->back_line_color = blob->back_line_color;
+  settings->side_line_color = blob->side_line_color;
+}
+
+static bool read_blob(SettingsBlob *out_blob)
+{
+  return persist_read_data(PERSIST_KEY_SETTINGS, out_blob, sizeof(*out_blob)) == (int)sizeof(*out_blob) &&
+    out_blob->version == SETTINGS_BLOB_VERSION && out_blob->checksum == blob_checksum(out_blob);
+}
+
+// The per-key layout could hold the 0 / 1 of an older boolean setting where a
+// colour is now; 1 meant white. Blob and delta colours are plain RGB.
+static int32_t read_legacy_color(uint32_t key, int32_t fallback)
+{
+  if (!persist_exists(key))
+  {
+    return fallback;
+  }
+
+  const int32_t value = persist_read_int(key);
+
+  return value == 1 ? 0xFFFFFF : value;
+}
+
+// Settings saved one key each by earlier versions; false when there are none.
+static bool load_legacy_settings(AppSettings *settings)
+{
+  if (!persist_exists(PERSIST_KEY_SLOW_VERSION) && !persist_exists(PERSIST_KEY_BG_COLOR))
+  {
+    return false;
+  }
+
   settings->slow_version = persist_exists(PERSIST_KEY_SLOW_VERSION) ? persist_read_bool(PERSIST_KEY_SLOW_VERSION) : DEFAULT_SETTING_SLOW_VERSION;
-  settings->bg_color = persist_exists(PERSIST_KEY_BG_COLOR) ? persist_read_int(PERSIST_KEY_BG_COLOR) : DEFAULT_SETTING_BG_COLOR;
-  settings->face_color = persist_exists(PERSIST_KEY_FACE_COLOR) ? persist_read_int(PERSIST_KEY_FACE_COLOR) : DEFAULT_SETTING_FACE_COLOR;
+  settings->bg_color = read_legacy_color(PERSIST_KEY_BG_COLOR, DEFAULT_SETTING_BG_COLOR);
+  settings->face_color = read_legacy_color(PERSIST_KEY_FACE_COLOR, DEFAULT_SETTING_FACE_COLOR);
   settings->face_mix_with_background = persist_exists(PERSIST_KEY_FACE_MIX_WITH_BACKGROUND)
     ? persist_read_bool(PERSIST_KEY_FACE_MIX_WITH_BACKGROUND)
     : DEFAULT_SETTING_FACE_MIX_WITH_BACKGROUND;
-  settings->line_color = persist_exists(PERSIST_KEY_LINE_COLOR)
-    ? persist_read_int(PERSIST_KEY_LINE_COLOR)
-    : DEFAULT_SETTING_LINE_COLOR;
+  settings->line_color = read_legacy_color(PERSIST_KEY_LINE_COLOR, DEFAULT_SETTING_LINE_COLOR);
   settings->line_mix_with_background = persist_exists(PERSIST_KEY_LINE_MIX_WITH_BACKGROUND)
     ? persist_read_bool(PERSIST_KEY_LINE_MIX_WITH_BACKGROUND)
     : DEFAULT_SETTING_LINE_MIX_WITH_BACKGROUND;
   settings->split_line_colors = persist_exists(PERSIST_KEY_SPLIT_LINE_COLORS)
     ? persist_read_bool(PERSIST_KEY_SPLIT_LINE_COLORS)
     : DEFAULT_SETTING_SPLIT_LINE_COLORS;
-  settings->back_line_color = persist_exists(PERSIST_KEY_BACK_LINE_COLOR)
-    ? persist_read_int(PERSIST_KEY_BACK_LINE_COLOR)
-    : DEFAULT_SETTING_BACK_LINE_COLOR;
-  settings->side_line_color = persist_exists(PERSIST_KEY_SIDE_LINE_COLOR)
-    ? persist_read_int(PERSIST_KEY_SIDE_LINE_COLOR)
-    : DEFAULT_SETTING_SIDE_LINE_COLOR;
+  settings->back_line_color = read_legacy_color(PERSIST_KEY_BACK_LINE_COLOR, DEFAULT_SETTING_BACK_LINE_COLOR);
+  settings->side_line_color = read_legacy_color(PERSIST_KEY_SIDE_LINE_COLOR, DEFAULT_SETTING_SIDE_LINE_COLOR);
 
-  sanitize_settings(settings);
+  return true;
 }
 
-void app_settings_save(const AppSettings *settings)
+static void delete_legacy_settings(void)
 {
-  persist_write_bool(PERSIST_KEY_SLOW_VERSION, settings->slow_version);
-  persist_write_int(PERSIST_KEY_BG_COLOR, settings->bg_color);
-  persist_write_int(PERSIST_KEY_FACE_COLOR, settings->face_color);
-  persist_write_bool(PERSIST_KEY_FACE_MIX_WITH_BACKGROUND, settings->face_mix_with_background);
-  persist_write_int(PERSIST_KEY_LINE_COLOR, settings->line_color);
-  persist_write_bool(PERSIST_KEY_LINE_MIX_WITH_BACKGROUND, settings->line_mix_with_background);
-  persist_write_bool(PERSIST_KEY_SPLIT_LINE_COLORS, settings->split_line_colors);
-  persist_write_int(PERSIST_KEY_BACK_LINE_COLOR, settings->back_line_color);
-  persist_write_int(PERSIST_KEY_SIDE_LINE_COLOR, settings->side_line_color);
+  for (uint32_t key = PERSIST_KEY_SLOW_VERSION; key <= PERSIST_KEY_SIDE_LINE_COLOR; ++key)
+  {
+    persist_delete(key);
+  }
 }
 
-bool app_settings_apply_message(AppSettings *settings, DictionaryIterator *iterator)
+static void load_defaults(AppSettings *settings)
+{
+  settings->slow_version = DEFAULT_SETTING_SLOW_VERSION;
+  settings->bg_color = DEFAULT_SETTING_BG_COLOR;
+  settings->face_color = DEFAULT_SETTING_FACE_COLOR;
+  settings->face_mix_with_background = DEFAULT_SETTING_FACE_MIX_WITH_BACKGROUND;
+  settings->line_color = DEFAULT_SETTING_LINE_COLOR;
+  settings->line_mix_with_background = DEFAULT_SETTING_LINE_MIX_WITH_BACKGROUND;
+  settings->split_line_colors = DEFAULT_SETTING_SPLIT_LINE_COLORS;
+  settings->back_line_color = DEFAULT_SETTING_BACK_LINE_COLOR;
+  settings->side_line_color = DEFAULT_SETTING_SIDE_LINE_COLOR;
+}
+
+// One persist read once the blob exists; the legacy keys are read, rewritten
+// as a blob and deleted once.
+void app_settings_load(AppSettings *settings)
+{
+  SettingsBlob blob;
+
+  s_has_stored_blob = read_blob(&blob);
+  if (s_has_stored_blob)
+  {
+    s_stored_blob = blob;
+    decode_blob(settings, &blob);
+    sanitize_settings(settings);
+    return;
+  }
+
+  if (!load_legacy_settings(settings))
+  {
+    load_defaults(settings);
+    sanitize_settings(settings);
+    return;
+  }
+
+  sanitize_settings(settings);
+  app_settings_save(settings);
+  if (s_has_stored_blob)
+  {
+    delete_legacy_settings();
+  }
+}
+
+void app_settings_save(const AppSettings *settings)
 {
-  bool changed = false;
-  Tuple *slow_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_SLOW_VERSION);
-  Tuple *bg_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_BG_COLOR);
-  Tuple *face_color_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_FACE_COLOR);
-  Tuple *face_mix_with_background_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_FACE_MIX_WITH_BACKGROUND);
-  Tuple *line_color_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_LINE_COLOR);
-  Tuple *line_mix_with_background_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_LINE_MIX_WITH_BACKGROUND);
-  Tuple *split_line_colors_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_SPLIT_LINE_COLORS);
-  Tuple *back_line_color_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_BACK_LINE_COLOR);
-  Tuple *side_line_color_tuple = dict_find(iterator, MESSAGE_KEY_SETTING_SIDE_LINE_COLOR);
+  SettingsBlob blob;
 
-  if (slow_tuple != NULL)
+  encode_blob(&blob, settings);
+  if (s_has_stored_blob && memcmp(&blob, &s_stored_blob, sizeof(blob)) == 0)
   {
-    settings->slow_version = slow_tuple->value->int32 != 0;
-    changed = true;
+    return;
   }
 
-  if (bg_tuple != NULL)
+  if (persist_write_data(PERSIST_KEY_SETTINGS, &blob, sizeof(blob)) == (int)sizeof(blob))
   {
-    settings->bg_color = bg_tuple->value->int32;
-    changed = true;
+    s_stored_blob = blob;
+    s_has_stored_blob = true;
   }
+}
 
-  if (face_color_tuple != NULL)
+// Tells the phone which settings the watch holds, so it sends all of them.
+static void send_checksum(const AppSettings *settings)
+{
+  const uint16_t checksum = app_settings_checksum(settings);
+  DictionaryIterator *iterator;
+
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK)
   {
-    settings->face_color = face_color_tuple->value->int32;
-    changed = true;
+    return;
   }
+  dict_write_int(iterator, MESSAGE_KEY_SETTINGS_CHECKSUM, &checksum, sizeof(checksum), false);
+  app_message_outbox_send();
+}
+
+// Applies a SETTINGS_DELTA to settings only when all of it parses and, unless
+// it carries every field, it was taken against the settings held here.
+static bool apply_delta(AppSettings *settings, const uint8_t *data, uint16_t length, bool *out_stale)
+{
+  AppSettings next = *settings;
+  int32_t *const colors[] = {
+    &next.bg_color, &next.face_color, &next.line_color, &next.back_line_color, &next.side_line_color,
+  };
+  uint16_t pos = SETTINGS_DELTA_HEADER_SIZE;
 
-  if (face_mix_with_background_tuple != NULL)
+  if (length < SETTINGS_DELTA_HEADER_SIZE || data[0] != SETTINGS_DELTA_VERSION)
   {
-    settings->face_mix_with_background = face_mix_with_background_tuple->value->int32 != 0;
-    changed = true;
+    return false;
   }
 
-  if (line_color_tuple != NULL)
+  const uint16_t base = (data[1] << 8) | data[2];
+  const uint8_t mask = data[3];
+
+  if (mask != SETTINGS_DELTA_ALL && base != app_settings_checksum(settings))
   {
-    settings->line_color = line_color_tuple->value->int32;
-    changed = true;
+    *out_stale = true;
+    return false;
   }
 
-  if (line_mix_with_background_tuple != NULL)
+  if (mask & SETTINGS_DELTA_FLAGS)
   {
-    settings->line_mix_with_background = line_mix_with_background_tuple->value->int32 != 0;
-    changed = true;
+    if (pos + 1 > length)
+    {
+      return false;
+    }
+    decode_flags(&next, data[pos++]);
   }
 
-  if (split_line_colors_tuple != NULL)
+  for (int i = 0; i < (int)ARRAY_LENGTH(colors); ++i)
   {
-    settings->split_line_colors = split_line_colors_tuple->value->int32 != 0;
-    changed = true;
+    if (!(mask & (SETTINGS_DELTA_BG_COLOR << i)))
+    {
+      continue;
+    }
+    if (pos + 3 > length)
+    {
+      return false;
+    }
+    *colors[i] = (data[pos] << 16) | (data[pos + 1] << 8) | data[pos + 2];
+    pos += 3;
   }
 
-  if (back_line_color_tuple != NULL)
+  *settings = next;
+  return true;
+}
+
+bool app_settings_apply_message(AppSettings *settings, DictionaryIterator *iterator)
+{
+  bool applied = false;
+  bool stale = false;
+  SettingsBlob before;
+  SettingsBlob after;
+
+  encode_blob(&before, settings);
+  for (Tuple *tuple = dict_read_first(iterator); tuple != NULL; tuple = dict_read_next(iterator))
   {
-    settings->back_line_color = back_line_color_tuple->value->int32;
-    changed = true;
+    if (tuple->key == MESSAGE_KEY_SETTINGS_DELTA && tuple->type == TUPLE_BYTE_ARRAY)
+    {
+      applied |= apply_delta(settings, tuple->value->data, tuple->length, &stale);
+    }
   }
 
-  if (side_line_color_tuple != NULL)
+  if (stale)
   {
-    settings->side_line_color = side_line_color_tuple->value->int32;
-    changed = true;
+    send_checksum(settings);
   }
 
-  if (changed)
+  if (!applied)
   {
-    sanitize_settings(settings);
+    return false;
   }
 
-  return changed;
+  sanitize_settings(settings);
+  encode_blob(&after, settings);
+  return memcmp(&before, &after, sizeof(before)) != 0;
 }
 
 GColor app_settings_get_background_color(const AppSettings *settings)
@@ -190,3 +404,22 @@ GColor app_settings_get_face_color(const AppSettings *settings)
     ? mix_with_background(settings, settings->face_color)
     : GColorFromHEX(settings->face_color);
 }
+
+void app_settings_resolve_palette(const AppSettings *settings, ResolvedPalette *out_palette)
+{
+  out_palette->background = app_settings_get_background_color(settings);
+  out_palette->face = app_settings_get_face_color(settings);
+  out_palette->front_line = app_settings_get_line_color(settings);
+  if (!settings->split_line_colors)
+  {
+    out_palette->back_line = out_palette->front_line;
+    out_palette->side_line = out_palette->front_line;
+    out_palette->single_line_color = true;
+    return;
+  }
+
+  out_palette->back_line = app_settings_get_back_line_color(settings);
+  out_palette->side_line = app_settings_get_side_line_color(settings);
+  out_palette->single_line_color = gcolor_equal(out_palette->back_line, out_palette->front_line) &&
+    gcolor_equal(out_palette->side_line, out_palette->front_line);
+}
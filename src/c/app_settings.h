@@ -15,8 +15,23 @@ typedef struct AppSettings
   int32_t side_line_color;
 } AppSettings;
 
+// The colours drawn with, resolved from AppSettings (mixes included) once per
+// settings change rather than per frame.
+typedef struct ResolvedPalette
+{
+  GColor background;
+  GColor face;
+  GColor back_line;
+  GColor side_line;
+  GColor front_line;
+  // back, side and front lines share one colour (split_line_colors off, or
+  // split into equal colours), so the line passes need one stroke colour
+  bool single_line_color;
+} ResolvedPalette;
+
 enum
 {
+  // legacy layout, one key per setting; migrated to PERSIST_KEY_SETTINGS on load
   PERSIST_KEY_SLOW_VERSION = 1,
   PERSIST_KEY_BG_COLOR = 2,
   PERSIST_KEY_FACE_COLOR = 3,
@@ -26,13 +41,25 @@ enum
   PERSIST_KEY_SPLIT_LINE_COLORS = 7,
   PERSIST_KEY_BACK_LINE_COLOR = 8,
   PERSIST_KEY_SIDE_LINE_COLOR = 9,
+  // perf_log.c's record ring
+  PERSIST_KEY_PERF_LOG = 10,
+  // every setting in one versioned, checksummed blob
+  PERSIST_KEY_SETTINGS = 11,
 };
 
 void app_settings_load(AppSettings *settings);
+// Writes only when the settings differ from the stored ones.
 void app_settings_save(const AppSettings *settings);
+// Fletcher-16 of the settings as a SETTINGS_DELTA carrying every field holds
+// them; a delta names the settings it was taken against by this.
+uint16_t app_settings_checksum(const AppSettings *settings);
+// Applies a SETTINGS_DELTA byte array (see app_settings.c) in one pass over the
+// message; true when it changed the sanitized settings. A delta taken against
+// other settings is dropped, and SETTINGS_CHECKSUM goes back to the phone.
 bool app_settings_apply_message(AppSettings *settings, DictionaryIterator *iterator);
 GColor app_settings_get_background_color(const AppSettings *settings);
 GColor app_settings_get_line_color(const AppSettings *settings);
 GColor app_settings_get_back_line_color(const AppSettings *settings);
 GColor app_settings_get_side_line_color(const AppSettings *settings);
 GColor app_settings_get_face_color(const AppSettings *settings);
+void app_settings_resolve_palette(const AppSettings *settings, ResolvedPalette *out_palette);
@@ -0,0 +1,44 @@
+#include "arena.h"
+
+#define ARENA_ALIGNMENT 8
+
+static union
+{
+  uint8_t bytes[ARENA_SIZE_BYTES];
+  // aligns the buffer for any state struct
+  uint64_t align;
+} s_arena;
+static size_t s_arena_used;
+
+void *arena_alloc(size_t size)
+{
+  const size_t aligned_size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+  void *block;
+
+  if (aligned_size > ARENA_SIZE_BYTES - s_arena_used)
+  {
+    return NULL;
+  }
+
+  block = &s_arena.bytes[s_arena_used];
+  s_arena_used += aligned_size;
+  return block;
+}
+
+void arena_release(void *block)
+{
+  const uint8_t *byte = block;
+
+  // already released along with an earlier block
+  if (byte == NULL || byte < s_arena.bytes || byte >= &s_arena.bytes[s_arena_used])
+  {
+    return;
+  }
+
+  s_arena_used = (size_t)(byte - s_arena.bytes);
+}
+
+size_t arena_bytes_used(void)
+{
+  return s_arena_used;
+}
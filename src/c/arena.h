@@ -0,0 +1,19 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// Module state carved from one static buffer sized at compile time, so no
+// module keeps its state on the heap. Blocks are released
+// last in, first out, the order init / deinit already nest in; releasing a
+// block also releases every block taken after it.
+
+// Can be overridden from the build.
+#ifndef ARENA_SIZE_BYTES
+#define ARENA_SIZE_BYTES (6 * 1024)
+#endif
+
+// NULL once the arena is full.
+void *arena_alloc(size_t size);
+void arena_release(void *block);
+size_t arena_bytes_used(void);
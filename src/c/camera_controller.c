@@ -1,4 +1,44 @@
 #include "camera_controller.h"
+#include "arena.h"
+#include "perf_log.h"
+#include "profiler.h"
+
+#define WAYPOINT_COUNT 4
+#define KEYFRAMES_PER_TRANSITION 16
+#define KEYFRAME_COUNT (WAYPOINT_COUNT * KEYFRAMES_PER_TRANSITION)
+#define FRAME_INTERVAL_MS 33
+#define LOW_BATTERY_FRAME_INTERVAL_MS 100
+#define LOW_BATTERY_PERCENT 20
+// an update this much early still renders, so tick jitter does not halve the rate
+#define FRAME_SLACK_MS 8
+// waypoint i sits at ORBIT_FIRST_ANGLE - i * ORBIT_STEP_ANGLE
+#define ORBIT_FIRST_ANGLE (TRIG_MAX_ANGLE / 8)
+#define ORBIT_STEP_ANGLE (TRIG_MAX_ANGLE / 4)
+
+// Rows 0-2 of a look_at view matrix, column by column; row 3 is always
+// (0, 0, 0, 1).
+typedef struct CameraKeyframe
+{
+  Scalar m[12];
+} CameraKeyframe;
+
+// Paces transition frames: an animation update that comes sooner than the
+// frame interval after the last rendered one is skipped, so slow redraws and
+// a low battery drop frames instead of queueing them.
+typedef struct FrameGovernor
+{
+  uint32_t last_frame_ms;
+  // smoothed time from an admitted update to the end of the redraw it caused
+  // (perf_log_frame_drawn), so it settles back once a slow frame has passed
+  uint16_t frame_cost_ms;
+  uint16_t target_interval_ms;
+  // last_frame_ms is set and the update after it has not been measured yet
+  bool has_frame;
+  bool cost_pending;
+  // this transition's admitted updates and longest measured frame, for perf_log
+  uint16_t frames;
+  uint16_t worst_frame_ms;
+} FrameGovernor;
 
 struct CameraControllerState
 {
@@ -8,20 +48,189 @@ struct CameraControllerState
   Vec3 up;
   Vec3 eye_from;
   int eye_to_idx;
+  // false when a transition was restarted midway; the path then leaves the table
+  bool eye_from_waypoint;
+  // waypoint the view matrix sits on exactly, -1 once it has left it
+  int view_waypoint;
   bool slow_mode;
+  // path of the running transition, and the one set for the next
+  CameraPath path;
+  CameraPath next_path;
+  // CAMERA_PATH_ORBIT: trig angle of the eye, and the transition's start and sweep
+  int32_t angle;
+  int32_t angle_from;
+  int32_t angle_delta;
+  FrameGovernor governor;
   AnimationImplementation anim_impl;
   Animation *anim;
   CameraInvalidateHandler invalidate_handler;
   void *invalidate_context;
+  // keyframe i * KEYFRAMES_PER_TRANSITION + j is transition i -> i + 1 at ratio j / KEYFRAMES_PER_TRANSITION
+  CameraKeyframe keyframes[KEYFRAME_COUNT];
 };
 
-static const Vec3 EYE_WAYPOINTS[] = {
-  { 1, 1, 1 },
-  { 1, -1, 1 },
-  { -1, -1, 1 },
-  { -1, 1, 1 }
+static const Vec3 EYE_WAYPOINTS[WAYPOINT_COUNT] = {
+  { SCALAR(1), SCALAR(1), SCALAR(1) },
+  { SCALAR(1), SCALAR(-1), SCALAR(1) },
+  { SCALAR(-1), SCALAR(-1), SCALAR(1) },
+  { SCALAR(-1), SCALAR(1), SCALAR(1) }
 };
 
+static void keyframe_pack(CameraKeyframe *out_keyframe, const Mat4 *m)
+{
+  for (int col = 0; col < 4; ++col)
+  {
+    for (int row = 0; row < 3; ++row)
+    {
+      out_keyframe->m[col * 3 + row] = m->m[col * 4 + row];
+    }
+  }
+}
+
+static void keyframe_lerp(Mat4 *out_m, const CameraKeyframe *from, const CameraKeyframe *to, Scalar ratio)
+{
+  for (int col = 0; col < 4; ++col)
+  {
+    for (int row = 0; row < 3; ++row)
+    {
+      const Scalar a = from->m[col * 3 + row];
+      const Scalar b = to->m[col * 3 + row];
+
+      out_m->m[col * 4 + row] = a + scalar_mul(b - a, ratio);
+    }
+  }
+
+  out_m->m[_30] = 0;
+  out_m->m[_31] = 0;
+  out_m->m[_32] = 0;
+  out_m->m[_33] = SCALAR_ONE;
+}
+
+static void build_keyframes(CameraControllerState *state)
+{
+  for (int i = 0; i < WAYPOINT_COUNT; ++i)
+  {
+    const Vec3 *from = &EYE_WAYPOINTS[i];
+    const Vec3 *to = &EYE_WAYPOINTS[(i + 1) % WAYPOINT_COUNT];
+
+    for (int j = 0; j < KEYFRAMES_PER_TRANSITION; ++j)
+    {
+      Scalar ratio = scalar_from_fraction(j, KEYFRAMES_PER_TRANSITION);
+      Vec3 eye = Vec3(
+        scalar_mul(from->x, SCALAR_ONE - ratio) + scalar_mul(to->x, ratio),
+        scalar_mul(from->y, SCALAR_ONE - ratio) + scalar_mul(to->y, ratio),
+        from->z);
+      Mat4 view_matrix;
+
+      mat4_look_at_rh(&view_matrix, &eye, &state->at, &state->up);
+      keyframe_pack(&state->keyframes[i * KEYFRAMES_PER_TRANSITION + j], &view_matrix);
+    }
+  }
+}
+
+static void set_view_from_keyframes(CameraControllerState *state, int from_idx,
+  AnimationProgress time_normalized)
+{
+  const int32_t steps = (int32_t)time_normalized * KEYFRAMES_PER_TRANSITION;
+  const int keyframe = from_idx * KEYFRAMES_PER_TRANSITION + steps / ANIMATION_NORMALIZED_MAX;
+  const Scalar ratio = scalar_from_fraction(steps % ANIMATION_NORMALIZED_MAX, ANIMATION_NORMALIZED_MAX);
+
+  keyframe_lerp(&state->view_matrix, &state->keyframes[keyframe % KEYFRAME_COUNT],
+    &state->keyframes[(keyframe + 1) % KEYFRAME_COUNT], ratio);
+}
+
+//==============================================================================
+// frame pacing
+
+static uint32_t now_ms(void)
+{
+  time_t seconds;
+  uint16_t ms;
+
+  time_ms(&seconds, &ms);
+  return (uint32_t)seconds * 1000 + ms;
+}
+
+// Peeked once per transition; the battery service has a single subscriber,
+// which belongs to the app. The cost estimate starts over too, so a slow frame
+// in one transition does not pace the next.
+static void frame_governor_begin(FrameGovernor *governor)
+{
+  const BatteryChargeState battery = battery_state_service_peek();
+
+  governor->target_interval_ms = !battery.is_charging && battery.charge_percent <= LOW_BATTERY_PERCENT ?
+    LOW_BATTERY_FRAME_INTERVAL_MS : FRAME_INTERVAL_MS;
+  governor->frame_cost_ms = 0;
+  governor->has_frame = false;
+  governor->cost_pending = false;
+  governor->frames = 0;
+  governor->worst_frame_ms = 0;
+}
+
+// Whether the update at time_normalized should move the camera and redraw. The
+// last update always does; anim_stopped then puts the camera on the waypoint.
+static bool frame_governor_admit(FrameGovernor *governor, AnimationProgress time_normalized)
+{
+  const uint32_t now = now_ms();
+  const uint32_t elapsed = now - governor->last_frame_ms;
+  uint16_t interval;
+
+  // A redraw stamped before the last admitted update means nothing drew since.
+  if (governor->cost_pending && perf_log_get_last_frame_ms() - governor->last_frame_ms <= elapsed)
+  {
+    const uint32_t drawn = perf_log_get_last_frame_ms() - governor->last_frame_ms;
+    const uint16_t cost = drawn < UINT16_MAX ? drawn : UINT16_MAX;
+
+    governor->frame_cost_ms = (uint16_t)(governor->frame_cost_ms + ((int32_t)cost - governor->frame_cost_ms) / 4);
+    governor->worst_frame_ms = cost > governor->worst_frame_ms ? cost : governor->worst_frame_ms;
+  }
+  governor->cost_pending = false;
+
+  interval = governor->frame_cost_ms > governor->target_interval_ms ?
+    governor->frame_cost_ms : governor->target_interval_ms;
+  if (governor->has_frame && time_normalized < ANIMATION_NORMALIZED_MAX && elapsed + FRAME_SLACK_MS < interval)
+  {
+    return false;
+  }
+
+  governor->last_frame_ms = now;
+  governor->has_frame = true;
+  governor->cost_pending = true;
+  ++governor->frames;
+  return true;
+}
+
+//==============================================================================
+
+// mat4_look_at_rh towards the origin with up (0, 1, 0) and the eye at
+// (sqrt(2) cos a, sqrt(2) sin a, 1), the circle through the waypoints. The eye
+// is always sqrt(3) away, so normalizing the forward vector is a constant
+// factor, and look_at's unnormalized side and up vectors come out as
+// polynomials in cos a and sin a: no square roots or cross products.
+static void set_view_from_angle(CameraControllerState *state, int32_t angle)
+{
+  static const Scalar INV_SQRT3 = SCALAR(0.57735027f);
+  static const Scalar SQRT2_DIV_SQRT3 = SCALAR(0.81649658f);
+  static const Scalar SQRT2_DIV_3 = SCALAR(0.47140452f);
+  static const Scalar SQRT3 = SCALAR(1.7320508f);
+  const int32_t cos_value = cos_lookup(angle);
+  const Scalar c = scalar_from_fraction(cos_value, TRIG_MAX_RATIO);
+  const Scalar s = scalar_from_fraction(sin_lookup(angle), TRIG_MAX_RATIO);
+  const Scalar c_over_3 = scalar_from_fraction(cos_value, 3 * TRIG_MAX_RATIO);
+
+  mat4_set(&state->view_matrix,
+    INV_SQRT3, 0, -scalar_mul(SQRT2_DIV_SQRT3, c), 0,
+    -2 * scalar_mul(c_over_3, s), 2 * scalar_mul(c_over_3, c) + scalar_from_fraction(1, 3),
+      -scalar_mul(SQRT2_DIV_3, s), 0,
+    scalar_mul(SQRT2_DIV_SQRT3, c), scalar_mul(SQRT2_DIV_SQRT3, s), INV_SQRT3, -SQRT3,
+    0, 0, 0, SCALAR_ONE);
+}
+
+static int32_t waypoint_angle(int waypoint)
+{
+  return (ORBIT_FIRST_ANGLE - waypoint * ORBIT_STEP_ANGLE) & (TRIG_MAX_ANGLE - 1);
+}
+
 static void invalidate(CameraController *controller)
 {
   if (controller->state->invalidate_handler != NULL)
@@ -32,6 +241,8 @@ static void invalidate(CameraController *controller)
 
 static void anim_stopped(struct Animation* animation, bool finished, void *context);
 
+// One per transition: SDK 3 frees an animation once its stopped handler
+// returns, so it can be neither rescheduled nor destroyed after that.
 static bool create_animation(CameraController *controller)
 {
   controller->state->anim = animation_create();
@@ -53,11 +264,38 @@ static bool create_animation(CameraController *controller)
 static void anim_update(struct Animation* animation, const AnimationProgress time_normalized)
 {
   CameraController *controller = animation_get_context(animation);
-  float ratio = (float)time_normalized / ANIMATION_NORMALIZED_MAX;
+  Scalar ratio = scalar_from_fraction(time_normalized, ANIMATION_NORMALIZED_MAX);
 
-  controller->state->eye.x = controller->state->eye_from.x * (1 - ratio) + EYE_WAYPOINTS[controller->state->eye_to_idx].x * ratio;
-  controller->state->eye.y = controller->state->eye_from.y * (1 - ratio) + EYE_WAYPOINTS[controller->state->eye_to_idx].y * ratio;
-  mat4_look_at_rh(&controller->state->view_matrix, &controller->state->eye, &controller->state->at, &controller->state->up);
+  // Skipped updates leave eye and angle alone too, so a restarted transition starts from the pose on screen.
+  if (!frame_governor_admit(&controller->state->governor, time_normalized))
+  {
+    return;
+  }
+  PROFILE_FRAME();
+  PROFILE_SCOPE(PROFILE_SECTION_ANIM_UPDATE);
+
+  controller->state->view_waypoint = -1;
+  if (controller->state->path == CAMERA_PATH_ORBIT)
+  {
+    controller->state->angle = (controller->state->angle_from +
+      (int32_t)(((int64_t)controller->state->angle_delta * time_normalized) / ANIMATION_NORMALIZED_MAX)) &
+      (TRIG_MAX_ANGLE - 1);
+    set_view_from_angle(controller->state, controller->state->angle);
+    invalidate(controller);
+    return;
+  }
+
+  controller->state->eye.x = scalar_mul(controller->state->eye_from.x, SCALAR_ONE - ratio) + scalar_mul(EYE_WAYPOINTS[controller->state->eye_to_idx].x, ratio);
+  controller->state->eye.y = scalar_mul(controller->state->eye_from.y, SCALAR_ONE - ratio) + scalar_mul(EYE_WAYPOINTS[controller->state->eye_to_idx].y, ratio);
+  if (controller->state->eye_from_waypoint)
+  {
+    set_view_from_keyframes(controller->state,
+      (controller->state->eye_to_idx + WAYPOINT_COUNT - 1) % WAYPOINT_COUNT, time_normalized);
+  }
+  else
+  {
+    mat4_look_at_rh(&controller->state->view_matrix, &controller->state->eye, &controller->state->at, &controller->state->up);
+  }
   invalidate(controller);
 }
 
@@ -65,27 +303,26 @@ static void anim_stopped(struct Animation* animation, bool finished, void *conte
 {
   CameraController *controller = context;
 
+  controller->state->anim = NULL;
+  PROFILE_TRANSITION_END();
+  perf_log_record_transition(controller->state->governor.frames, controller->state->governor.worst_frame_ms);
   if (!finished)
   {
     return;
   }
 
   controller->state->eye = EYE_WAYPOINTS[controller->state->eye_to_idx];
-  mat4_look_at_rh(&controller->state->view_matrix, &controller->state->eye, &controller->state->at, &controller->state->up);
+  controller->state->angle = waypoint_angle(controller->state->eye_to_idx);
+  controller->state->view_waypoint = controller->state->eye_to_idx;
+  set_view_from_keyframes(controller->state, controller->state->eye_to_idx, 0);
   invalidate(controller);
-
-  animation_destroy(animation);
-  if (controller->state->anim == animation)
-  {
-    controller->state->anim = NULL;
-  }
 }
 
 bool camera_controller_init(CameraController *controller, bool slow_mode,
   CameraInvalidateHandler invalidate_handler, void *invalidate_context)
 {
   controller->state = NULL;
-  controller->state = malloc(sizeof(CameraControllerState));
+  controller->state = arena_alloc(sizeof(CameraControllerState));
   if (controller->state == NULL)
   {
     return false;
@@ -96,15 +333,24 @@ bool camera_controller_init(CameraController *controller, bool slow_mode,
   controller->state->slow_mode = slow_mode;
   controller->state->eye = EYE_WAYPOINTS[0];
   controller->state->at = Vec3(0, 0, 0);
-  controller->state->up = Vec3(0, 1, 0);
+  controller->state->up = Vec3(0, SCALAR_ONE, 0);
   controller->state->eye_from = controller->state->eye;
   controller->state->eye_to_idx = 0;
+  controller->state->eye_from_waypoint = true;
+  controller->state->view_waypoint = 0;
+  controller->state->path = CAMERA_PATH_KEYFRAMES;
+  controller->state->next_path = CAMERA_PATH_KEYFRAMES;
+  controller->state->angle = waypoint_angle(0);
+  controller->state->angle_from = controller->state->angle;
+  controller->state->angle_delta = 0;
+  controller->state->governor.last_frame_ms = 0;
+  frame_governor_begin(&controller->state->governor);
   controller->state->anim = NULL;
   controller->state->anim_impl.setup = NULL;
   controller->state->anim_impl.update = anim_update;
   controller->state->anim_impl.teardown = NULL;
-  mat4_look_at_rh(&controller->state->view_matrix, &controller->state->eye,
-    &controller->state->at, &controller->state->up);
+  build_keyframes(controller->state);
+  set_view_from_keyframes(controller->state, 0, 0);
 
   return true;
 }
@@ -116,14 +362,13 @@ void camera_controller_deinit(CameraController *controller)
     return;
   }
 
+  // the stopped handler clears anim; the system frees it
   if (controller->state->anim != NULL)
   {
     animation_unschedule(controller->state->anim);
-    animation_destroy(controller->state->anim);
-    controller->state->anim = NULL;
   }
 
-  free(controller->state);
+  arena_release(controller->state);
   controller->state = NULL;
 }
 
@@ -137,6 +382,16 @@ void camera_controller_set_slow_mode(CameraController *controller, bool slow_mod
   controller->state->slow_mode = slow_mode;
 }
 
+void camera_controller_set_path(CameraController *controller, CameraPath path)
+{
+  if (controller->state == NULL)
+  {
+    return;
+  }
+
+  controller->state->next_path = path;
+}
+
 void camera_controller_start_transition(CameraController *controller)
 {
   if (controller->state == NULL)
@@ -144,22 +399,29 @@ void camera_controller_start_transition(CameraController *controller)
     return;
   }
 
-  if (controller->state->anim != NULL && animation_is_scheduled(controller->state->anim))
+  if (controller->state->anim != NULL)
   {
     animation_unschedule(controller->state->anim);
   }
 
-  if (controller->state->anim == NULL)
+  // Each path only knows how to pick up its own half-finished transition, so
+  // the path changes between transitions that start on a waypoint.
+  if (controller->state->view_waypoint >= 0)
   {
-    if (!create_animation(controller))
-    {
-      return;
-    }
+    controller->state->path = controller->state->next_path;
   }
-
   controller->state->eye_from = controller->state->eye;
-  controller->state->eye_to_idx = (controller->state->eye_to_idx + 1) % ARRAY_LENGTH(EYE_WAYPOINTS);
-  if (controller->state->anim != NULL)
+  controller->state->eye_from_waypoint =
+    controller->state->eye.x == EYE_WAYPOINTS[controller->state->eye_to_idx].x &&
+    controller->state->eye.y == EYE_WAYPOINTS[controller->state->eye_to_idx].y;
+  controller->state->eye_to_idx = (controller->state->eye_to_idx + 1) % WAYPOINT_COUNT;
+  // clockwise from wherever the eye is, a quarter turn from a waypoint
+  controller->state->angle_from = controller->state->angle;
+  controller->state->angle_delta = -(int32_t)((uint32_t)(controller->state->angle_from -
+    waypoint_angle(controller->state->eye_to_idx)) % TRIG_MAX_ANGLE);
+  frame_governor_begin(&controller->state->governor);
+  PROFILE_TRANSITION_BEGIN(controller->state->governor.target_interval_ms);
+  if (create_animation(controller))
   {
     animation_schedule(controller->state->anim);
   }
@@ -175,6 +437,16 @@ const Mat4 *camera_controller_get_view_matrix(const CameraController *controller
   return &controller->state->view_matrix;
 }
 
+int camera_controller_get_waypoint_index(const CameraController *controller)
+{
+  if (controller->state == NULL)
+  {
+    return -1;
+  }
+
+  return controller->state->view_waypoint;
+}
+
 bool camera_controller_is_ready(const CameraController *controller)
 {
   return controller->state != NULL;
@@ -5,6 +5,14 @@
 
 typedef void (*CameraInvalidateHandler)(void *context);
 
+typedef enum CameraPath
+{
+  // eye on straight lines between the waypoints, views lerped from the keyframe table
+  CAMERA_PATH_KEYFRAMES,
+  // eye orbiting the z axis at constant angular speed, views built from sin_lookup / cos_lookup
+  CAMERA_PATH_ORBIT,
+} CameraPath;
+
 typedef struct CameraControllerState CameraControllerState;
 
 typedef struct CameraController
@@ -16,6 +24,11 @@ bool camera_controller_init(CameraController *controller, bool slow_mode,
   CameraInvalidateHandler invalidate_handler, void *invalidate_context);
 void camera_controller_deinit(CameraController *controller);
 void camera_controller_set_slow_mode(CameraController *controller, bool slow_mode);
+// CAMERA_PATH_KEYFRAMES after init. Takes effect with the next transition that
+// starts on a waypoint.
+void camera_controller_set_path(CameraController *controller, CameraPath path);
 void camera_controller_start_transition(CameraController *controller);
 const Mat4 *camera_controller_get_view_matrix(const CameraController *controller);
+// Waypoint the view matrix rests on, or -1 while the camera is between waypoints.
+int camera_controller_get_waypoint_index(const CameraController *controller);
 bool camera_controller_is_ready(const CameraController *controller);
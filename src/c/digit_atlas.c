@@ -0,0 +1,272 @@
+#include "digit_atlas.h"
+#include "arena.h"
+
+#define ATLAS_VERSION 1
+#define ATLAS_DIGIT_COUNT 10
+#define ATLAS_MAX_WAYPOINTS 4
+#define ATLAS_HEADER_SIZE 12
+#define ATLAS_INDEX_ENTRY_SIZE 12
+#define ATLAS_FLIP_X 0x01
+#define ATLAS_FLIP_Y 0x02
+#define ATLAS_PATCH_PIXEL_SIZE 3
+// runs and patches are read through a stack buffer this big
+#define ATLAS_CHUNK_SIZE (32 * ATLAS_PATCH_PIXEL_SIZE)
+
+typedef struct DigitAtlasEntry
+{
+  uint32_t run_offset;
+  uint16_t run_length;
+  uint8_t flags;
+  uint8_t patch_count;
+  uint32_t patch_offset;
+} DigitAtlasEntry;
+
+struct DigitAtlasState
+{
+  ResHandle handle;
+  GSize glyph_size;
+  int waypoint_count;
+  DigitAtlasEntry entries[ATLAS_DIGIT_COUNT * ATLAS_MAX_WAYPOINTS];
+};
+
+static uint16_t read_u16(const uint8_t *data)
+{
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static bool header_matches(const DigitAtlasState *state, const uint8_t *header)
+{
+  return memcmp(header, "FZAT", 4) == 0 && header[4] == ATLAS_VERSION && header[5] == ATLAS_DIGIT_COUNT &&
+    header[6] > 0 && header[6] <= ATLAS_MAX_WAYPOINTS && read_u16(&header[8]) == state->glyph_size.w &&
+    read_u16(&header[10]) == state->glyph_size.h;
+}
+
+static bool load_bytes(ResHandle handle, uint32_t offset, uint8_t *buffer, size_t size)
+{
+  return size == 0 || resource_load_byte_range(handle, offset, buffer, size) == size;
+}
+
+static bool load_index(DigitAtlasState *state)
+{
+  const int entry_count = ATLAS_DIGIT_COUNT * state->waypoint_count;
+  uint8_t data[ATLAS_INDEX_ENTRY_SIZE];
+
+  for (int i = 0; i < entry_count; ++i)
+  {
+    if (!load_bytes(state->handle, ATLAS_HEADER_SIZE + i * ATLAS_INDEX_ENTRY_SIZE, data, sizeof(data)))
+    {
+      return false;
+    }
+
+    state->entries[i].run_offset = read_u32(&data[0]);
+    state->entries[i].run_length = read_u16(&data[4]);
+    state->entries[i].flags = data[6];
+    state->entries[i].patch_count = data[7];
+    state->entries[i].patch_offset = read_u32(&data[8]);
+  }
+
+  return true;
+}
+
+// Only black and white platforms ship the atlas (package.json): colour
+// displays antialias the live lines, which an ink map cannot hold, so their
+// resting glyphs are captured from the live draw instead.
+static ResHandle get_resource_handle(void)
+{
+#ifdef PBL_COLOR
+  return NULL;
+#else
+  return resource_get_handle(RESOURCE_ID_DIGIT_ATLAS);
+#endif
+}
+
+//==============================================================================
+// decoding
+
+typedef struct SpanMapper
+{
+  int axis_x;
+  int axis_y;
+  uint8_t flags;
+  GSize size;
+  DigitAtlasSpanHandler span_handler;
+  void *context;
+} SpanMapper;
+
+// Mirrored columns and rows map c -> axis - c; anything that lands outside the
+// glyph is dropped (the generator's patch covers it).
+static void emit_span(const SpanMapper *mapper, int y, int x0, int x1, DigitAtlasInk ink)
+{
+  if (mapper->flags & ATLAS_FLIP_Y)
+  {
+    y = mapper->axis_y - y;
+  }
+  if (mapper->flags & ATLAS_FLIP_X)
+  {
+    const int mirrored_x0 = mapper->axis_x - x1;
+
+    x1 = mapper->axis_x - x0;
+    x0 = mirrored_x0;
+  }
+
+  x0 = x0 > 0 ? x0 : 0;
+  x1 = x1 < mapper->size.w - 1 ? x1 : mapper->size.w - 1;
+  if (y < 0 || y >= mapper->size.h || x0 > x1)
+  {
+    return;
+  }
+
+  mapper->span_handler(y, x0, x1, ink, mapper->context);
+}
+
+// Decodes one chunk of runs from *cursor on; false on runs that leave the glyph.
+static bool decode_runs(const SpanMapper *mapper, GPoint *cursor, const uint8_t *runs, int run_length)
+{
+  int x = cursor->x;
+  int y = cursor->y;
+
+  for (int i = 0; i < run_length; ++i)
+  {
+    const DigitAtlasInk ink = (DigitAtlasInk)(runs[i] >> 5);
+    const int length = (runs[i] & 0x1f) + 1;
+
+    if (ink >= DIGIT_ATLAS_INK_COUNT || y >= mapper->size.h || x + length > mapper->size.w)
+    {
+      return false;
+    }
+
+    if (ink != DIGIT_ATLAS_INK_NONE)
+    {
+      emit_span(mapper, y, x, x + length - 1, ink);
+    }
+
+    x += length;
+    if (x == mapper->size.w)
+    {
+      x = 0;
+      ++y;
+    }
+  }
+
+  *cursor = GPoint(x, y);
+  return true;
+}
+
+static void apply_patch(const SpanMapper *mapper, const uint8_t *patch, int patch_count)
+{
+  for (int i = 0; i < patch_count; ++i)
+  {
+    const uint8_t *pixel = &patch[i * ATLAS_PATCH_PIXEL_SIZE];
+
+    if (pixel[0] < mapper->size.w && pixel[1] < mapper->size.h && pixel[2] < DIGIT_ATLAS_INK_COUNT)
+    {
+      mapper->span_handler(pixel[1], pixel[0], pixel[0], (DigitAtlasInk)pixel[2], mapper->context);
+    }
+  }
+}
+
+//==============================================================================
+
+bool digit_atlas_init(DigitAtlas *atlas, GSize glyph_size)
+{
+  DigitAtlasState *state;
+  uint8_t header[ATLAS_HEADER_SIZE];
+
+  atlas->state = NULL;
+  state = arena_alloc(sizeof(DigitAtlasState));
+  if (state == NULL)
+  {
+    return false;
+  }
+
+  state->handle = get_resource_handle();
+  state->glyph_size = glyph_size;
+  if (state->handle == NULL ||
+    !load_bytes(state->handle, 0, header, sizeof(header)) || !header_matches(state, header))
+  {
+    arena_release(state);
+    return false;
+  }
+
+  state->waypoint_count = header[6];
+  if (!load_index(state))
+  {
+    arena_release(state);
+    return false;
+  }
+
+  atlas->state = state;
+  return true;
+}
+
+void digit_atlas_deinit(DigitAtlas *atlas)
+{
+  if (atlas->state == NULL)
+  {
+    return;
+  }
+
+  arena_release(atlas->state);
+  atlas->state = NULL;
+}
+
+bool digit_atlas_decode(const DigitAtlas *atlas, int digit, int waypoint,
+  DigitAtlasSpanHandler span_handler, void *context)
+{
+  const DigitAtlasState *state = atlas->state;
+  const DigitAtlasEntry *entry;
+  uint8_t chunk[ATLAS_CHUNK_SIZE];
+  GPoint cursor = GPoint(0, 0);
+  int patch_size;
+
+  if (state == NULL || digit < 0 || digit >= ATLAS_DIGIT_COUNT || waypoint < 0 ||
+    waypoint >= state->waypoint_count)
+  {
+    return false;
+  }
+
+  entry = &state->entries[digit * state->waypoint_count + waypoint];
+  patch_size = entry->patch_count * ATLAS_PATCH_PIXEL_SIZE;
+
+  const SpanMapper mapper = {
+    .axis_x = state->glyph_size.w / 2 * 2,
+    .axis_y = state->glyph_size.h / 2 * 2,
+    .flags = entry->flags,
+    .size = state->glyph_size,
+    .span_handler = span_handler,
+    .context = context,
+  };
+
+  for (int offset = 0; offset < entry->run_length; offset += ATLAS_CHUNK_SIZE)
+  {
+    const int size = entry->run_length - offset < ATLAS_CHUNK_SIZE ? entry->run_length - offset : ATLAS_CHUNK_SIZE;
+
+    if (!load_bytes(state->handle, entry->run_offset + offset, chunk, size) ||
+      !decode_runs(&mapper, &cursor, chunk, size))
+    {
+      return false;
+    }
+  }
+  if (cursor.y != mapper.size.h)
+  {
+    return false;
+  }
+
+  for (int offset = 0; offset < patch_size; offset += ATLAS_CHUNK_SIZE)
+  {
+    const int size = patch_size - offset < ATLAS_CHUNK_SIZE ? patch_size - offset : ATLAS_CHUNK_SIZE;
+
+    if (!load_bytes(state->handle, entry->patch_offset + offset, chunk, size))
+    {
+      return false;
+    }
+    apply_patch(&mapper, chunk, size / ATLAS_PATCH_PIXEL_SIZE);
+  }
+
+  return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// Build-time renders of every digit at every camera waypoint (host/atlas_main.c,
+// black and white platforms only), stored as run-length encoded ink maps in
+// RESOURCE_ID_DIGIT_ATLAS and decoded on demand.
+
+typedef enum DigitAtlasInk
+{
+  DIGIT_ATLAS_INK_NONE,
+  DIGIT_ATLAS_INK_FACE,
+  DIGIT_ATLAS_INK_BACK_LINE,
+  DIGIT_ATLAS_INK_SIDE_LINE,
+  DIGIT_ATLAS_INK_FRONT_LINE,
+  DIGIT_ATLAS_INK_COUNT
+} DigitAtlasInk;
+
+// Pixels x0..x1 (inclusive) of row y get ink; DIGIT_ATLAS_INK_NONE clears.
+typedef void (*DigitAtlasSpanHandler)(int y, int x0, int x1, DigitAtlasInk ink, void *context);
+
+typedef struct DigitAtlasState DigitAtlasState;
+
+typedef struct DigitAtlas
+{
+  DigitAtlasState *state;
+} DigitAtlas;
+
+// Fails when the resource is missing or was built for another glyph size.
+bool digit_atlas_init(DigitAtlas *atlas, GSize glyph_size);
+void digit_atlas_deinit(DigitAtlas *atlas);
+// Emits every inked span of the glyph into a cleared glyph_size target; false
+// for waypoints the atlas was not built with.
+bool digit_atlas_decode(const DigitAtlas *atlas, int digit, int waypoint,
+  DigitAtlasSpanHandler span_handler, void *context);
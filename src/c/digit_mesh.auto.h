@@ -0,0 +1,86 @@
+#pragma once
+
+// Generated by scripts/compile-digit-mesh.js from config/digit-mesh.json.
+
+#define DIGIT_MESH_POINT_COUNT 20
+#define DIGIT_MESH_DIGIT_COUNT 10
+#define DIGIT_MESH_QUADRANT_COUNT 4
+#define DIGIT_MESH_MAX_CAP_POINTS 12
+
+// Ranges into the shared tables below.
+typedef struct DigitMesh
+{
+  // front edges, in pairs of digit_mesh_edges
+  uint8_t edge_start;
+  uint8_t edge_count;
+  // outline points in digit_mesh_side_points
+  uint8_t side_start;
+  uint8_t side_count;
+  // caps in digit_mesh_cap_starts
+  uint8_t cap_start;
+  uint8_t cap_count;
+  // per eye quadrant (bit 0: eye x < 0, bit 1: eye y < 0): bit k is set when the side face of
+  // edge k faces the eye
+  uint16_t visible_side_faces[DIGIT_MESH_QUADRANT_COUNT];
+  // points the outline uses
+  uint32_t point_mask;
+} DigitMesh;
+
+static const int8_t digit_mesh_point_x[DIGIT_MESH_POINT_COUNT] = { 0, 10, 20, 30, 0, 10, 20, 30, 0, 10, 20, 30, 0, 10, 20, 30, 0, 10, 20, 30 };
+static const int8_t digit_mesh_point_y[DIGIT_MESH_POINT_COUNT] = { 0, 0, 0, 0, 10, 10, 10, 10, 20, 20, 20, 20, 30, 30, 30, 30, 40, 40, 40, 40 };
+
+// Front edges as point index pairs; back edges are the same pairs offset by DIGIT_MESH_POINT_COUNT.
+static const uint8_t digit_mesh_edges[] = {
+  0, 3,  3, 19,  19, 16,  16, 0,  5, 6,  6, 14,  14, 13,  13, 5,
+  1, 2,  2, 18,  18, 17,  17, 1,
+  0, 3,  3, 7,  7, 6,  6, 10,  10, 11,  11, 19,  19, 16,  16, 12,  12, 14,  14, 10,  10, 8,  8, 0,
+  0, 3,  3, 19,  19, 16,  16, 12,  12, 13,  13, 9,  9, 10,  10, 6,  6, 4,  4, 0,
+  2, 3,  3, 19,  19, 18,  18, 14,  14, 13,  13, 17,  17, 16,  16, 8,  8, 10,  10, 2,
+  0, 3,  3, 11,  11, 10,  10, 14,  14, 15,  15, 19,  19, 16,  16, 8,  8, 10,  10, 6,  6, 4,  4, 0,
+  0, 3,  3, 11,  11, 9,  9, 17,  17, 16,  16, 0,
+  1, 2,  2, 10,  10, 11,  11, 19,  19, 16,  16, 12,  12, 14,  14, 10,  10, 9,  9, 1,
+  0, 3,  3, 19,  19, 16,  16, 0,  5, 6,  6, 10,  10, 9,  9, 5,
+  2, 3,  3, 19,  19, 16,  16, 8,  8, 10,  10, 2,
+};
+
+// Each outline point has a side edge to its back point, DIGIT_MESH_POINT_COUNT further on.
+static const uint8_t digit_mesh_side_points[] = {
+  0, 3, 19, 16, 5, 6, 14, 13,
+  1, 2, 18, 17,
+  0, 3, 7, 6, 10, 11, 19, 16, 12, 14, 8,
+  0, 3, 19, 16, 12, 13, 9, 10, 6, 4,
+  2, 3, 19, 18, 14, 13, 17, 16, 8, 10,
+  0, 3, 11, 10, 14, 15, 19, 16, 8, 6, 4,
+  0, 3, 11, 9, 17, 16,
+  1, 2, 10, 11, 19, 16, 12, 14, 9,
+  0, 3, 19, 16, 5, 6, 10, 9,
+  2, 3, 19, 16, 8, 10,
+};
+
+// z = 10 cap polygons as back point indices; cap i spans cap_starts[i] .. cap_starts[i + 1].
+static const uint8_t digit_mesh_cap_points[] = {
+  20, 21, 33, 35, 39, 36, 20, 23, 39, 38, 26, 24,
+  21, 22, 38, 37,
+  20, 23, 27, 26, 30, 31, 39, 36, 32, 34, 30, 28,
+  20, 23, 39, 36, 32, 33, 29, 30, 26, 24,
+  22, 23, 39, 38, 34, 33, 37, 36, 28, 30,
+  20, 23, 31, 30, 34, 35, 39, 36, 28, 30, 26, 24,
+  20, 23, 31, 29, 37, 36,
+  21, 22, 30, 31, 39, 36, 32, 34, 30, 29,
+  20, 21, 29, 31, 39, 36, 20, 23, 39, 38, 26, 24,
+  22, 23, 39, 36, 28, 30,
+};
+static const uint8_t digit_mesh_cap_starts[] = { 0, 6, 12, 16, 28, 38, 48, 60, 66, 76, 82, 88, 94 };
+
+static const DigitMesh digit_meshes[] = {
+  { 0, 8, 0, 8, 0, 2, { 0x0096, 0x003c, 0x00c3, 0x0069 }, 0x00096069 },
+  { 8, 4, 8, 4, 2, 1, { 0x0006, 0x000c, 0x0003, 0x0009 }, 0x00060006 },
+  { 12, 12, 12, 11, 3, 1, { 0x046e, 0x0ec4, 0x013b, 0x0b91 }, 0x00095dc9 },
+  { 24, 10, 23, 10, 4, 1, { 0x0106, 0x03ac, 0x0053, 0x02f9 }, 0x00093659 },
+  { 34, 10, 33, 10, 5, 1, { 0x0076, 0x02dc, 0x0123, 0x0389 }, 0x000f650c },
+  { 44, 12, 43, 11, 6, 1, { 0x046e, 0x0ec4, 0x013b, 0x0b91 }, 0x0009cd59 },
+  { 56, 6, 54, 6, 7, 1, { 0x001e, 0x0034, 0x000b, 0x0021 }, 0x00030a09 },
+  { 62, 10, 60, 9, 8, 1, { 0x011a, 0x03b0, 0x004f, 0x02e5 }, 0x00095e06 },
+  { 72, 8, 69, 8, 9, 2, { 0x0096, 0x003c, 0x00c3, 0x0069 }, 0x00090669 },
+  { 80, 6, 77, 6, 11, 1, { 0x0006, 0x002c, 0x0013, 0x0039 }, 0x0009050c },
+};
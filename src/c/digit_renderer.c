@@ -1,39 +1,155 @@
 #include "digit_renderer.h"
-#include "poly_data.h"
+#include "arena.h"
+#include "digit_atlas.h"
+#include "framebuffer.h"
+#include "glyph_cache.h"
+#include "perf_log.h"
+#include "profiler.h"
+#include "digit_mesh.auto.h"
 
 #define DIGIT_RENDERER_DIGIT_COUNT 4
-#define DIGIT_SHARED_POINT_COUNT ((int)ARRAY_LENGTH(digit_poly_points))
+#define SILHOUETTE_MAX_POLYS 24
+#define SILHOUETTE_MAX_POLY_POINTS DIGIT_MESH_MAX_CAP_POINTS
+#define SILHOUETTE_MAX_SPANS 32
+#define SILHOUETTE_MAX_EDGES 80
+
+// Colour displays antialias graphics_draw_line. framebuffer_draw_line draws
+// hard edges and only exists for 1-bit framebuffers, so the line passes only go
+// into the framebuffer on black and white; the fills under them do everywhere.
+#ifdef PBL_BW
+#define FRAMEBUFFER_LINES
+#endif
 
-typedef struct Poly
+// The app always fills into the captured framebuffer, through the graphics
+// context when the capture fails. DIGIT_RENDERER_FILL_MODES (host bench only)
+// compiles in the other fill modes the bench compares it with.
+typedef enum DigitFillMode
 {
-  Vec3 center;
-  const DigitPolyData *poly_data;
-} Poly;
+  // one gpath per visible face
+  DIGIT_FILL_FACES,
+  // the union of the visible faces, one rect per row span
+  DIGIT_FILL_SILHOUETTE,
+  // the same spans, and the line passes, written straight into the captured
+  // framebuffer
+  DIGIT_FILL_FRAMEBUFFER,
+} DigitFillMode;
+
+#ifdef DIGIT_RENDERER_FILL_MODES
+#define FILL_MODE(state) ((state)->fill_mode)
+#else
+#define FILL_MODE(state) DIGIT_FILL_FRAMEBUFFER
+#endif
+
+typedef struct PolyLayerData
+{
+  DigitRenderer *renderer;
+  const DigitMesh *mesh;
+  Vec3 pos;
+  GPoint center_screen_pos;
+  // model space -> layer-local screen space, rebuilt whenever the view changes
+  Mat4 model_view;
+  // affine model_view: back points are the front points plus this offset
+  bool affine;
+  Vec3 screen_extrusion;
+  int eye_quadrant;
+  // the single-layer layout skips hidden digits itself
+  bool hidden;
+  // projected with the view, in the coordinates of the full digit_layer_size rect
+  GPoint screen_poss[DIGIT_MESH_POINT_COUNT * 2];
+} PolyLayerData;
 
 struct DigitRendererState
 {
+  DigitRendererLayout layout;
+  // DIGIT_RENDERER_LAYER_PER_DIGIT
   Layer *digits[DIGIT_RENDERER_DIGIT_COUNT];
-  Poly number_polys[10];
+  // DIGIT_RENDERER_SINGLE_LAYER
+  Layer *canvas;
+  PolyLayerData digit_data[DIGIT_RENDERER_DIGIT_COUNT];
   GPoint screen_center;
-  float poly_scale;
+  Scalar poly_scale;
+  Vec3 poly_center;
   GSize digit_layer_size;
   Vec3 digit_positions[DIGIT_RENDERER_DIGIT_COUNT];
+  Vec3 model_points[DIGIT_MESH_POINT_COUNT * 2];
   const AppSettings *settings;
+  // resolved from settings in init and digit_renderer_mark_all_dirty
+  ResolvedPalette palette;
   const Mat4 *view_matrix;
+  // camera waypoint while at rest, -1 during transitions
+  int waypoint_index;
+  GlyphCache glyph_cache;
+  // optional; resting glyphs are rendered live when it is missing
+  DigitAtlas atlas;
+#ifdef DIGIT_RENDERER_FILL_MODES
+  // the atlas is generated with the silhouette spans
+  DigitFillMode fill_mode;
+#endif
 };
 
-typedef struct PolyLayerData
+typedef struct LiveGlyphDraw
 {
-  DigitRenderer *renderer;
-  Poly *poly_ref;
-  Vec3 pos;
-} PolyLayerData;
+  const PolyLayerData *data;
+  GPoint origin;
+  // drawing coordinates -> screen, and the drawing layer's frame on screen
+  GPoint screen_offset;
+  GRect screen_clip;
+} LiveGlyphDraw;
+
+typedef struct AtlasGlyphLoad
+{
+  const DigitRendererState *state;
+  int digit;
+  GlyphWriter *writer;
+  GColor inks[DIGIT_ATLAS_INK_COUNT];
+} AtlasGlyphLoad;
+
+typedef struct SilhouettePoly
+{
+  uint8_t point_idxs[SILHOUETTE_MAX_POLY_POINTS];
+  uint8_t point_count;
+} SilhouettePoly;
+
+// One non-horizontal face edge, stepped down the rows y_top .. y_end - 1. x is
+// where it crosses the current row's centre, rounded half up, kept exact as
+// x + error / denominator so the fixed point platforms stay off soft float.
+typedef struct ScanEdge
+{
+  int16_t y_top;
+  int16_t y_end;
+  int16_t x;
+  int16_t x_step;
+  int16_t error;
+  int16_t error_step;
+  int16_t denominator;
+  uint8_t face;
+} ScanEdge;
+
+typedef struct SilhouetteCrossing
+{
+  int16_t x;
+  uint8_t face;
+} SilhouetteCrossing;
 
-typedef struct ContourInfo
+typedef struct SilhouetteSpan
 {
-  uint8_t start;
-  uint8_t length;
-} ContourInfo;
+  int16_t x0;
+  int16_t x1;
+} SilhouetteSpan;
+
+// Where silhouette spans and lines go: the graphics context, or straight into
+// the captured framebuffer when there is one.
+typedef struct DrawTarget
+{
+  GContext *ctx;
+  GBitmap *framebuffer;
+  // drawing coordinates -> framebuffer coordinates
+  GPoint offset;
+  // the drawing layer's part of the framebuffer
+  GRect clip;
+  GColor fill_color;
+  GColor stroke_color;
+} DrawTarget;
 
 static int round_to_int(float value)
 {
@@ -49,15 +165,17 @@ static void configure_layout(DigitRenderer *renderer, GRect bounds)
 #ifdef PBL_ROUND
   layout_scale *= 0.9f;
 #endif
+  const float poly_scale = 1.4f * layout_scale;
 
-  state->poly_scale = 1.4f * layout_scale;
+  state->poly_scale = scalar_from_float(poly_scale);
+  state->poly_center = Vec3(15 * state->poly_scale, 20 * state->poly_scale, 6 * state->poly_scale);
   state->screen_center = grect_center_point(&bounds);
-  state->digit_layer_size = GSize(round_to_int(40.0f * state->poly_scale),
-    round_to_int(50.0f * state->poly_scale));
+  state->digit_layer_size = GSize(round_to_int(40.0f * poly_scale),
+    round_to_int(50.0f * poly_scale));
 
   {
-    const float digit_offset_x = 35.0f * layout_scale;
-    const float digit_offset_y = 42.0f * layout_scale;
+    const Scalar digit_offset_x = scalar_from_float(35.0f * layout_scale);
+    const Scalar digit_offset_y = scalar_from_float(42.0f * layout_scale);
     state->digit_positions[0] = Vec3(-digit_offset_x, digit_offset_y, 0);
     state->digit_positions[1] = Vec3(digit_offset_x, digit_offset_y, 0);
     state->digit_positions[2] = Vec3(-digit_offset_x, -digit_offset_y, 0);
@@ -65,12 +183,24 @@ static void configure_layout(DigitRenderer *renderer, GRect bounds)
   }
 }
 
+static void init_model_points(DigitRendererState *state)
+{
+  for (int i = 0; i < DIGIT_MESH_POINT_COUNT; ++i)
+  {
+    const Scalar x = scalar_from_int(digit_mesh_point_x[i]);
+    const Scalar y = scalar_from_int(digit_mesh_point_y[i]);
+
+    state->model_points[i] = Vec3(x, y, 0);
+    state->model_points[i + DIGIT_MESH_POINT_COUNT] = Vec3(x, y, scalar_from_int(10));
+  }
+}
+
 static void view_to_screen_pos(GPoint* out_screen_pos, const DigitRenderer *renderer, const Vec3 *view_pos)
 {
   const DigitRendererState *state = renderer->state;
 
-  out_screen_pos->x = state->screen_center.x + round_to_int(view_pos->x);
-  out_screen_pos->y = state->screen_center.y - round_to_int(view_pos->y);
+  out_screen_pos->x = state->screen_center.x + scalar_round_to_int(view_pos->x);
+  out_screen_pos->y = state->screen_center.y - scalar_round_to_int(view_pos->y);
 }
 
 static void world_to_screen_pos(GPoint* out_screen_pos, const DigitRenderer *renderer, const Vec3 *world_pos)
@@ -80,37 +210,147 @@ static void world_to_screen_pos(GPoint* out_screen_pos, const DigitRenderer *ren
   view_to_screen_pos(out_screen_pos, renderer, &view_pos);
 }
 
-static void poly_init(Poly* poly)
+// Row 2 of a look-at view matrix points from the target towards the eye.
+static int eye_quadrant(const Mat4 *view_matrix)
 {
-  poly->center = Vec3(0, 0, 0);
-  poly->poly_data = NULL;
+  return (view_matrix->m[_20] < 0 ? 1 : 0) | (view_matrix->m[_21] < 0 ? 2 : 0);
 }
 
-static void init_number_poly(DigitRenderer *renderer, Poly *poly, int number)
+static void update_model_view(const DigitRenderer *renderer, PolyLayerData *data)
 {
-  poly_init(poly);
-  poly->center = Vec3(15 * renderer->state->poly_scale, 20 * renderer->state->poly_scale, 6 * renderer->state->poly_scale);
-  poly->poly_data = &digit_poly_data[number];
+  const DigitRendererState *state = renderer->state;
+  Mat4 *m = &data->model_view;
+  Vec3 model_origin;
+
+  world_to_screen_pos(&data->center_screen_pos, renderer, &data->pos);
+  vec3_multiply(&model_origin, &state->poly_center, -SCALAR_ONE);
+  mat4_translate_scale(m, state->view_matrix, &model_origin, state->poly_scale);
+
+  // Fold the layer-local screen mapping in: x' = x + w / 2, y' = h / 2 - y. The digit position
+  // only moves the layer frame, so a glyph rasterizes the same in every slot.
+  const Scalar offset_x = scalar_from_int(state->digit_layer_size.w / 2);
+  const Scalar offset_y = scalar_from_int(state->digit_layer_size.h / 2);
+
+  for (int col = 0; col < 4; ++col)
+  {
+    const Scalar w = m->m[col * 4 + 3];
+
+    m->m[col * 4 + 0] = m->m[col * 4 + 0] + scalar_mul(offset_x, w);
+    m->m[col * 4 + 1] = scalar_mul(offset_y, w) - m->m[col * 4 + 1];
+  }
+
+  data->eye_quadrant = eye_quadrant(state->view_matrix);
+  data->affine = mat4_is_affine(m);
+  data->screen_extrusion = Vec3(scalar_mul(m->m[_02], scalar_from_int(10)),
+    scalar_mul(m->m[_12], scalar_from_int(10)), scalar_mul(m->m[_22], scalar_from_int(10)));
 }
 
-static void project_model_point(GPoint *out_screen_pos,
-  const DigitRenderer *renderer, const Poly *poly, const PolyLayerData *data, float x, float y, float z,
-  GPoint center_screen_pos, GSize frame_size)
+static void project_model_points(GPoint *out_screen_poss, const PolyLayerData *data)
 {
-  Vec3 local_pos = Vec3(x, y, z);
-  Vec3 model_pos, scale_pos, world_pos, view_pos;
+  DigitRendererState *state = data->renderer->state;
+  Vec3 screen_poss[DIGIT_MESH_POINT_COUNT * 2];
+
+  if (data->affine)
+  {
+    mat4_transform_points_affine(screen_poss, &data->model_view, state->model_points, DIGIT_MESH_POINT_COUNT);
+    for (int i = 0; i < DIGIT_MESH_POINT_COUNT; ++i)
+    {
+      vec3_plus(&screen_poss[i + DIGIT_MESH_POINT_COUNT], &screen_poss[i], &data->screen_extrusion);
+    }
+    PROFILE_COUNT(PROFILE_COUNTER_TRANSFORMS, DIGIT_MESH_POINT_COUNT);
+  }
+  else
+  {
+    mat4_transform_points(screen_poss, &data->model_view, state->model_points, DIGIT_MESH_POINT_COUNT * 2);
+    PROFILE_COUNT(PROFILE_COUNTER_TRANSFORMS, DIGIT_MESH_POINT_COUNT * 2);
+  }
 
-  vec3_multiply(&scale_pos, &local_pos, renderer->state->poly_scale);
-  vec3_minus(&model_pos, &scale_pos, &poly->center);
-  vec3_plus(&world_pos, &data->pos, &model_pos);
-  mat4_multiply_vec3(&view_pos, renderer->state->view_matrix, &world_pos);
+  for (int i = 0; i < DIGIT_MESH_POINT_COUNT * 2; ++i)
+  {
+    out_screen_poss[i].x = scalar_round_to_int(screen_poss[i].x);
+    out_screen_poss[i].y = scalar_round_to_int(screen_poss[i].y);
+  }
+}
 
-  view_to_screen_pos(out_screen_pos, renderer, &view_pos);
-  out_screen_pos->x = out_screen_pos->x - center_screen_pos.x + frame_size.w / 2;
-  out_screen_pos->y = out_screen_pos->y - center_screen_pos.y + frame_size.h / 2;
+static PolyLayerData *poly_layer_get_data(const Layer *layer)
+{
+  return *(PolyLayerData **)layer_get_data(layer);
 }
 
-static void draw_filled_path(GContext *ctx, GPoint *points, int point_num, GColor color)
+static GRect glyph_rect(const DigitRendererState *state, const PolyLayerData *data)
+{
+  return GRect(data->center_screen_pos.x - state->digit_layer_size.w / 2,
+    data->center_screen_pos.y - state->digit_layer_size.h / 2,
+    state->digit_layer_size.w, state->digit_layer_size.h);
+}
+
+// Inclusive pixel bounds of the digit's projected points, clipped to the full
+// glyph rect. Antialiased lines on colour platforms blend into the pixel next
+// to an end point, so the bounds keep one pixel around the points there.
+static GRect projected_bounds(const PolyLayerData *data, GSize size)
+{
+  const int pad = PBL_IF_COLOR_ELSE(1, 0);
+  const uint32_t point_mask = data->mesh->point_mask;
+  int min_x = size.w;
+  int min_y = size.h;
+  int max_x = -1;
+  int max_y = -1;
+
+  for (int i = 0; i < DIGIT_MESH_POINT_COUNT * 2; ++i)
+  {
+    const GPoint point = data->screen_poss[i];
+
+    if (!(point_mask & ((uint32_t)1 << (i % DIGIT_MESH_POINT_COUNT))))
+    {
+      continue;
+    }
+
+    min_x = point.x < min_x ? point.x : min_x;
+    min_y = point.y < min_y ? point.y : min_y;
+    max_x = point.x > max_x ? point.x : max_x;
+    max_y = point.y > max_y ? point.y : max_y;
+  }
+
+  min_x -= pad;
+  min_y -= pad;
+  max_x += pad;
+  max_y += pad;
+  min_x = min_x > 0 ? min_x : 0;
+  min_y = min_y > 0 ? min_y : 0;
+  max_x = max_x < size.w - 1 ? max_x : size.w - 1;
+  max_y = max_y < size.h - 1 ? max_y : size.h - 1;
+  if (min_x > max_x || min_y > max_y)
+  {
+    return GRect(0, 0, 0, 0);
+  }
+
+  return GRect(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+}
+
+// While the camera moves the frame shrinks to the digit's projected bounds, so
+// less of the screen is cleared and composited. Resting glyphs come from the
+// glyph cache and keep the full rect. The bounds origin always lines up with
+// the full rect, so drawing code sees the same coordinates either way.
+static void update_layer_frame(const DigitRendererState *state, Layer *layer)
+{
+  const PolyLayerData *data = poly_layer_get_data(layer);
+  const GSize size = state->digit_layer_size;
+  GRect box = GRect(0, 0, size.w, size.h);
+
+  if (state->waypoint_index < 0 && data->mesh != NULL)
+  {
+    box = projected_bounds(data, size);
+  }
+
+  const GRect full = glyph_rect(state, data);
+
+  layer_set_frame(layer, GRect(full.origin.x + box.origin.x, full.origin.y + box.origin.y,
+    box.size.w, box.size.h));
+  layer_set_bounds(layer, GRect(-box.origin.x, -box.origin.y, size.w, size.h));
+}
+
+#ifdef DIGIT_RENDERER_FILL_MODES
+static void draw_filled_path(GContext *ctx, GPoint *points, int point_num)
 {
   GPathInfo path_info = {
     .num_points = point_num,
@@ -123,180 +363,710 @@ static void draw_filled_path(GContext *ctx, GPoint *points, int point_num, GColo
     .offset = GPointZero,
   };
 
-  graphics_context_set_fill_color(ctx, color);
   gpath_draw_filled(ctx, &path);
+  PROFILE_COUNT(PROFILE_COUNTER_FILLS, 1);
 }
 
-static void draw_solid_poly(GContext *ctx, const DigitRenderer *renderer, const Poly *poly,
-  const PolyLayerData *data, GPoint center_screen_pos, GSize frame_size,
-  const PolyPath *solid_poly, float z, GColor color)
+static void draw_indexed_path(GContext *ctx, const GPoint *screen_poss, const uint8_t *point_idxs,
+  int point_count)
 {
-  GPoint points[16];
+  GPoint points[DIGIT_MESH_MAX_CAP_POINTS];
 
-  for (int i = 0; i < solid_poly->point_count; ++i)
+  for (int i = 0; i < point_count; ++i)
   {
-    GPoint point = digit_poly_points[solid_poly->point_idxs[i]];
-    project_model_point(&points[i], renderer, poly, data, point.x, point.y, z,
-      center_screen_pos, frame_size);
+    points[i] = screen_poss[point_idxs[i]];
   }
 
-  draw_filled_path(ctx, points, solid_poly->point_count, color);
+  draw_filled_path(ctx, points, point_count);
+}
+#endif
+
+// The side face of front edge i: front a, front b, back b, back a.
+static void side_face_points(uint8_t *out_point_idxs, const DigitMesh *mesh, int i)
+{
+  const uint8_t *edge = &digit_mesh_edges[(mesh->edge_start + i) * 2];
+
+  out_point_idxs[0] = edge[0];
+  out_point_idxs[1] = edge[1];
+  out_point_idxs[2] = edge[1] + DIGIT_MESH_POINT_COUNT;
+  out_point_idxs[3] = edge[0] + DIGIT_MESH_POINT_COUNT;
 }
 
-static void draw_side_face(GContext *ctx, GPoint *screen_poss,
-  int front_a, int front_b, int back_offset, GColor color)
+#ifdef DIGIT_RENDERER_FILL_MODES
+// Every face shares the fill colour, so only the faces looking at the eye are filled: the z = 10
+// cap (the eye stays in z = 1) and the side faces listed for the eye's quadrant. Together they
+// cover the digit's silhouette.
+static void draw_poly_fill(GContext *ctx, const DigitMesh *mesh, const GPoint *screen_poss, int quadrant)
 {
-  GPoint points[4];
-  int back_a = front_a + back_offset;
-  int back_b = front_b + back_offset;
+  const uint8_t *cap_starts = &digit_mesh_cap_starts[mesh->cap_start];
+  const uint16_t visible = mesh->visible_side_faces[quadrant];
+
+  for (int i = 0; i < mesh->cap_count; ++i)
+  {
+    draw_indexed_path(ctx, screen_poss, &digit_mesh_cap_points[cap_starts[i]], cap_starts[i + 1] - cap_starts[i]);
+  }
 
-  points[0] = screen_poss[front_a];
-  points[1] = screen_poss[front_b];
-  points[2] = screen_poss[back_b];
-  points[3] = screen_poss[back_a];
+  for (int i = 0; i < mesh->edge_count; ++i)
+  {
+    if (visible & (1 << i))
+    {
+      uint8_t quad[4];
 
-  draw_filled_path(ctx, points, 4, color);
+      side_face_points(quad, mesh, i);
+      draw_indexed_path(ctx, screen_poss, quad, 4);
+    }
+  }
 }
+#endif
 
-static int parse_front_contours(const DigitPolyData *poly_data, ContourInfo *contours)
+//==============================================================================
+// silhouette fill
+
+static void add_silhouette_poly(SilhouettePoly *polys, int *poly_count, const uint8_t *point_idxs,
+  int point_count)
 {
-  for (int i = 0; i < poly_data->contour_count; ++i)
+  SilhouettePoly *silhouette_poly = &polys[*poly_count];
+
+  if (*poly_count >= SILHOUETTE_MAX_POLYS || point_count < 3 || point_count > SILHOUETTE_MAX_POLY_POINTS)
   {
-    contours[i].start = i;
-    contours[i].length = poly_data->contours[i].point_count;
+    return;
   }
 
-  return poly_data->contour_count;
+  silhouette_poly->point_count = point_count;
+  memcpy(silhouette_poly->point_idxs, point_idxs, point_count);
+  ++*poly_count;
 }
 
-static void draw_poly_fill(GContext *ctx, const DigitRenderer *renderer, Poly *poly,
-  const PolyLayerData *data, GPoint center_screen_pos, GSize frame_size, GPoint *screen_poss)
+// The faces draw_poly_fill would fill.
+static int collect_visible_faces(SilhouettePoly *polys, const DigitMesh *mesh, int quadrant)
 {
-  ContourInfo contours[4];
-  const DigitPolyData *poly_data = poly->poly_data;
-  int contour_num = parse_front_contours(poly_data, contours);
-  int back_offset = DIGIT_SHARED_POINT_COUNT;
-  GColor fill_color = app_settings_get_face_color(renderer->state->settings);
+  const uint8_t *cap_starts = &digit_mesh_cap_starts[mesh->cap_start];
+  const uint16_t visible = mesh->visible_side_faces[quadrant];
+  int poly_count = 0;
+
+  for (int i = 0; i < mesh->cap_count; ++i)
+  {
+    add_silhouette_poly(polys, &poly_count, &digit_mesh_cap_points[cap_starts[i]], cap_starts[i + 1] - cap_starts[i]);
+  }
+
+  for (int i = 0; i < mesh->edge_count; ++i)
+  {
+    if (visible & (1 << i))
+    {
+      uint8_t quad[4];
+
+      side_face_points(quad, mesh, i);
+      add_silhouette_poly(polys, &poly_count, quad, 4);
+    }
+  }
 
-  for (int i = 0; i < poly_data->solid_poly_count; ++i)
+  return poly_count;
+}
+
+static int floor_div(int numerator, int denominator)
+{
+  if (denominator < 0)
   {
-    const PolyPath *solid_poly = &poly_data->solid_polys[i];
+    numerator = -numerator;
+    denominator = -denominator;
+  }
 
-    draw_solid_poly(ctx, renderer, poly, data, center_screen_pos, frame_size,
-      solid_poly, 0.0f, fill_color);
-    draw_solid_poly(ctx, renderer, poly, data, center_screen_pos, frame_size,
-      solid_poly, 10.0f, fill_color);
+  return numerator >= 0 ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+}
+
+// Row top.y crosses at top.x + floor((dx + dy) / 2dy); every further row adds
+// 2dx / 2dy.
+static void init_scan_edge(ScanEdge *edge, GPoint a, GPoint b, int face)
+{
+  const GPoint top = a.y < b.y ? a : b;
+  const GPoint bottom = a.y < b.y ? b : a;
+  const int dx = bottom.x - top.x;
+  const int denominator = 2 * (bottom.y - top.y);
+  const int numerator = dx + denominator / 2;
+  const int offset = floor_div(numerator, denominator);
+  const int x_step = floor_div(2 * dx, denominator);
+
+  edge->y_top = top.y;
+  edge->y_end = bottom.y;
+  edge->x = top.x + offset;
+  edge->x_step = x_step;
+  edge->error = numerator - offset * denominator;
+  edge->error_step = 2 * dx - x_step * denominator;
+  edge->denominator = denominator;
+  edge->face = face;
+}
+
+static void step_scan_edge(ScanEdge *edge)
+{
+  edge->x += edge->x_step;
+  edge->error += edge->error_step;
+  if (edge->error >= edge->denominator)
+  {
+    edge->error -= edge->denominator;
+    ++edge->x;
   }
+}
 
-  for (int i = 0; i < contour_num; ++i)
+// Edges of every face, sorted by first row. A face that does not fit is left
+// out whole so each face still crosses every row an even number of times.
+static int build_edge_table(ScanEdge *edges, const SilhouettePoly *polys, int poly_count,
+  const GPoint *screen_poss)
+{
+  int edge_count = 0;
+
+  for (int i = 0; i < poly_count && edge_count + polys[i].point_count <= SILHOUETTE_MAX_EDGES; ++i)
   {
-    for (int j = 0; j < contours[i].length; ++j)
+    for (int j = 0; j < polys[i].point_count; ++j)
     {
-      const PolyPath *contour = &poly_data->contours[contours[i].start];
-      int front_a = contour->point_idxs[j];
-      int front_b = contour->point_idxs[(j + 1) % contours[i].length];
-      draw_side_face(ctx, screen_poss, front_a, front_b, back_offset, fill_color);
+      const GPoint a = screen_poss[polys[i].point_idxs[j]];
+      const GPoint b = screen_poss[polys[i].point_idxs[(j + 1) % polys[i].point_count]];
+      ScanEdge edge;
+      int k = edge_count;
+
+      if (a.y == b.y)
+      {
+        continue;
+      }
+
+      init_scan_edge(&edge, a, b, i);
+      for (; k > 0 && edges[k - 1].y_top > edge.y_top; --k)
+      {
+        edges[k] = edges[k - 1];
+      }
+      edges[k] = edge;
+      ++edge_count;
     }
   }
+
+  return edge_count;
 }
 
-static void poly_layer_update_proc(Layer *layer, GContext* ctx)
+// Even-odd spans [x0, x1) of every face on the current row: the active
+// crossings sorted by face, then x, pair up within each face.
+static int collect_row_spans(SilhouetteSpan *spans, const ScanEdge *edges, const uint8_t *active,
+  int active_count)
 {
-  PolyLayerData *data = layer_get_data(layer);
-  DigitRenderer *renderer = data->renderer;
-  Poly* poly = data->poly_ref;
+  static SilhouetteCrossing crossings[SILHOUETTE_MAX_EDGES];
+  int span_count = 0;
 
-  if (poly == NULL)
+  for (int i = 0; i < active_count; ++i)
   {
-    return;
+    const SilhouetteCrossing crossing = { edges[active[i]].x, edges[active[i]].face };
+    int k = i;
+
+    for (; k > 0 && (crossings[k - 1].face > crossing.face ||
+      (crossings[k - 1].face == crossing.face && crossings[k - 1].x > crossing.x)); --k)
+    {
+      crossings[k] = crossings[k - 1];
+    }
+    crossings[k] = crossing;
   }
 
-  static GPoint screen_poss[DIGIT_SHARED_POINT_COUNT * 2];
-  GPoint center_screen_pos;
-  GRect frame = layer_get_frame(layer);
+  for (int i = 0; i + 1 < active_count && span_count < SILHOUETTE_MAX_SPANS; i += 2)
+  {
+    if (crossings[i].x < crossings[i + 1].x)
+    {
+      spans[span_count++] = (SilhouetteSpan){ crossings[i].x, crossings[i + 1].x };
+    }
+  }
 
-  world_to_screen_pos(&center_screen_pos, renderer, &data->pos);
+  return span_count;
+}
+
+static void fill_span(const DrawTarget *target, int y, int x0, int x1)
+{
+  PROFILE_COUNT(PROFILE_COUNTER_FILLS, 1);
+  if (target->framebuffer == NULL)
+  {
+    graphics_fill_rect(target->ctx, GRect(x0, y, x1 - x0, 1), 0, GCornerNone);
+    return;
+  }
 
-  frame.origin.x = center_screen_pos.x - frame.size.w / 2;
-  frame.origin.y = center_screen_pos.y - frame.size.h / 2;
-  layer_set_frame(layer, frame);
+  const GRect clip = target->clip;
 
-  for (int i = 0; i < DIGIT_SHARED_POINT_COUNT; ++i)
+  y += target->offset.y;
+  x0 += target->offset.x;
+  x1 += target->offset.x;
+  x0 = x0 > clip.origin.x ? x0 : clip.origin.x;
+  x1 = x1 < clip.origin.x + clip.size.w ? x1 : clip.origin.x + clip.size.w;
+  if (y < clip.origin.y || y >= clip.origin.y + clip.size.h || x0 >= x1)
   {
-    GPoint point = digit_poly_points[i];
-    project_model_point(&screen_poss[i], renderer, poly, data, point.x, point.y, 0.0f,
-      center_screen_pos, frame.size);
-    project_model_point(&screen_poss[i + DIGIT_SHARED_POINT_COUNT], renderer, poly, data, point.x, point.y, 10.0f,
-      center_screen_pos, frame.size);
+    return;
   }
 
-  draw_poly_fill(ctx, renderer, poly, data, center_screen_pos, frame.size, screen_poss);
+  const FramebufferRow row = framebuffer_get_row(target->framebuffer, y);
+
+  framebuffer_row_fill(&row, x0, x1 - 1, target->fill_color);
+}
 
-  graphics_context_set_stroke_color(ctx, app_settings_get_back_line_color(renderer->state->settings));
-  for (int i = 0; i < poly->poly_data->contour_count; ++i)
+static void fill_merged_spans(const DrawTarget *target, SilhouetteSpan *spans, int span_count, int y)
+{
+  for (int i = 1; i < span_count; ++i)
   {
-    const PolyPath *contour = &poly->poly_data->contours[i];
-    for (int j = 0; j < contour->point_count; ++j)
+    const SilhouetteSpan span = spans[i];
+    int k = i;
+
+    for (; k > 0 && spans[k - 1].x0 > span.x0; --k)
     {
-      int front_a = contour->point_idxs[j];
-      int front_b = contour->point_idxs[(j + 1) % contour->point_count];
-      int back_a = front_a + DIGIT_SHARED_POINT_COUNT;
-      int back_b = front_b + DIGIT_SHARED_POINT_COUNT;
+      spans[k] = spans[k - 1];
+    }
+    spans[k] = span;
+  }
+
+  for (int i = 0; i < span_count;)
+  {
+    int x0 = spans[i].x0;
+    int x1 = spans[i].x1;
 
-      graphics_draw_line(ctx, screen_poss[back_a], screen_poss[back_b]);
+    for (++i; i < span_count && spans[i].x0 <= x1; ++i)
+    {
+      x1 = spans[i].x1 > x1 ? spans[i].x1 : x1;
     }
+
+    fill_span(target, y, x0, x1);
   }
+}
 
-  graphics_context_set_stroke_color(ctx, app_settings_get_side_line_color(renderer->state->settings));
-  for (int i = 0; i < poly->poly_data->contour_count; ++i)
+// Same faces and coverage as draw_poly_fill, but each row of the digit's
+// silhouette is written once instead of once per overlapping face. The edge
+// table steps every edge down its rows, so a row only looks at the edges
+// that cross it.
+static void draw_silhouette_fill(const DrawTarget *target, const DigitMesh *mesh, const GPoint *screen_poss,
+  int quadrant)
+{
+  // static: together over 2 KB, too much for an update proc's stack on aplite
+  static SilhouettePoly polys[SILHOUETTE_MAX_POLYS];
+  static ScanEdge edges[SILHOUETTE_MAX_EDGES];
+  static uint8_t active[SILHOUETTE_MAX_EDGES];
+  static SilhouetteSpan spans[SILHOUETTE_MAX_SPANS];
+  const int poly_count = collect_visible_faces(polys, mesh, quadrant);
+  const int edge_count = build_edge_table(edges, polys, poly_count, screen_poss);
+  int active_count = 0;
+  int next = 0;
+
+  for (int y = edge_count > 0 ? edges[0].y_top : 0; next < edge_count || active_count > 0; ++y)
   {
-    const PolyPath *contour = &poly->poly_data->contours[i];
-    for (int j = 0; j < contour->point_count; ++j)
+    int kept = 0;
+
+    for (int i = 0; i < active_count; ++i)
+    {
+      if (edges[active[i]].y_end > y)
+      {
+        active[kept++] = active[i];
+      }
+    }
+    active_count = kept;
+    for (; next < edge_count && edges[next].y_top <= y; ++next)
     {
-      int front_a = contour->point_idxs[j];
-      int back_a = front_a + DIGIT_SHARED_POINT_COUNT;
+      active[active_count++] = next;
+    }
+
+    if (active_count == 0)
+    {
+      // skip to the next face's first row
+      if (next < edge_count)
+      {
+        y = edges[next].y_top - 1;
+      }
+      continue;
+    }
+
+    fill_merged_spans(target, spans, collect_row_spans(spans, edges, active, active_count), y);
+    for (int i = 0; i < active_count; ++i)
+    {
+      step_scan_edge(&edges[active[i]]);
+    }
+  }
+}
+
+//==============================================================================
+
+// Edges are pairs of front point indices; offset DIGIT_MESH_POINT_COUNT draws the back edges.
+static void draw_line(const DrawTarget *target, GPoint p0, GPoint p1)
+{
+  PROFILE_COUNT(PROFILE_COUNTER_LINES, 1);
+#ifdef FRAMEBUFFER_LINES
+  if (target->framebuffer != NULL)
+  {
+    const GPoint offset = target->offset;
+
+    framebuffer_draw_line(target->framebuffer, GPoint(p0.x + offset.x, p0.y + offset.y),
+      GPoint(p1.x + offset.x, p1.y + offset.y), target->clip, target->stroke_color);
+    return;
+  }
+#endif
+  graphics_draw_line(target->ctx, p0, p1);
+}
+
+static void draw_edges(const DrawTarget *target, const uint8_t *edges, int edge_count, int offset,
+  const GPoint *screen_poss)
+{
+  for (int i = 0; i < edge_count; ++i)
+  {
+    draw_line(target, screen_poss[edges[i * 2] + offset], screen_poss[edges[i * 2 + 1] + offset]);
+  }
+}
+
+static void draw_back_lines(const DrawTarget *target, const DigitMesh *mesh, const GPoint *screen_poss)
+{
+  PROFILE_SCOPE(PROFILE_SECTION_BACK_LINES);
+  draw_edges(target, &digit_mesh_edges[mesh->edge_start * 2], mesh->edge_count, DIGIT_MESH_POINT_COUNT,
+    screen_poss);
+}
+
+static void draw_side_lines(const DrawTarget *target, const DigitMesh *mesh, const GPoint *screen_poss)
+{
+  const uint8_t *side_points = &digit_mesh_side_points[mesh->side_start];
+  PROFILE_SCOPE(PROFILE_SECTION_SIDE_LINES);
+
+  for (int i = 0; i < mesh->side_count; ++i)
+  {
+    draw_line(target, screen_poss[side_points[i]], screen_poss[side_points[i] + DIGIT_MESH_POINT_COUNT]);
+  }
+}
+
+static void draw_front_lines(const DrawTarget *target, const DigitMesh *mesh, const GPoint *screen_poss)
+{
+  PROFILE_SCOPE(PROFILE_SECTION_FRONT_LINES);
+  draw_edges(target, &digit_mesh_edges[mesh->edge_start * 2], mesh->edge_count, 0, screen_poss);
+}
+
+// Captures the framebuffer for the fill and line passes when the fill mode
+// writes to it; without it everything goes through the graphics context.
+static void draw_target_begin(DrawTarget *target, GContext *ctx, const DigitRendererState *state,
+  GPoint offset, GRect clip)
+{
+  target->ctx = ctx;
+  target->framebuffer = NULL;
+  target->offset = offset;
+
+  if (FILL_MODE(state) == DIGIT_FILL_FRAMEBUFFER)
+  {
+    target->framebuffer = graphics_capture_frame_buffer(ctx);
+  }
+  if (target->framebuffer != NULL)
+  {
+    target->clip = framebuffer_clip_rect(target->framebuffer, clip);
+  }
+}
+
+static void draw_target_end(DrawTarget *target)
+{
+  if (target->framebuffer != NULL)
+  {
+    graphics_release_frame_buffer(target->ctx, target->framebuffer);
+    target->framebuffer = NULL;
+  }
+}
+
+// Between the fill and the line passes.
+static void draw_target_begin_lines(DrawTarget *target)
+{
+#ifndef FRAMEBUFFER_LINES
+  draw_target_end(target);
+#endif
+}
+
+static void draw_target_set_fill_color(DrawTarget *target, GColor color)
+{
+  target->fill_color = color;
+  if (target->framebuffer == NULL)
+  {
+    graphics_context_set_fill_color(target->ctx, color);
+  }
+}
+
+static void draw_target_set_stroke_color(DrawTarget *target, GColor color)
+{
+  PROFILE_COUNT(PROFILE_COUNTER_STROKE_COLORS, 1);
+  target->stroke_color = color;
+  if (target->framebuffer == NULL)
+  {
+    graphics_context_set_stroke_color(target->ctx, color);
+  }
+}
+
+static void fill_digit(const DrawTarget *target, const DigitRendererState *state, const PolyLayerData *data,
+  const GPoint *screen_poss)
+{
+  PROFILE_SCOPE(PROFILE_SECTION_FILL);
+
+#ifdef DIGIT_RENDERER_FILL_MODES
+  if (state->fill_mode == DIGIT_FILL_FACES)
+  {
+    draw_poly_fill(target->ctx, data->mesh, screen_poss, data->eye_quadrant);
+    return;
+  }
+#endif
+  draw_silhouette_fill(target, data->mesh, screen_poss, data->eye_quadrant);
+}
+
+// The projected points moved to a glyph rect at origin.
+static const GPoint *offset_screen_poss(GPoint *out_screen_poss, const PolyLayerData *data, GPoint origin)
+{
+  if (origin.x == 0 && origin.y == 0)
+  {
+    return data->screen_poss;
+  }
 
-      graphics_draw_line(ctx, screen_poss[front_a], screen_poss[back_a]);
+  for (int i = 0; i < DIGIT_MESH_POINT_COUNT * 2; ++i)
+  {
+    out_screen_poss[i] = GPoint(data->screen_poss[i].x + origin.x, data->screen_poss[i].y + origin.y);
+  }
+  return out_screen_poss;
+}
+
+static void draw_poly_live(GContext *ctx, void *context)
+{
+  const LiveGlyphDraw *draw = context;
+  const PolyLayerData *data = draw->data;
+  const DigitRendererState *state = data->renderer->state;
+  const DigitMesh *mesh = data->mesh;
+  static GPoint offset_poss[DIGIT_MESH_POINT_COUNT * 2];
+  const GPoint *screen_poss = offset_screen_poss(offset_poss, data, draw->origin);
+  const ResolvedPalette *palette = &state->palette;
+  DrawTarget target;
+
+  draw_target_begin(&target, ctx, state, draw->screen_offset, draw->screen_clip);
+  draw_target_set_fill_color(&target, palette->face);
+  fill_digit(&target, state, data, screen_poss);
+
+  draw_target_begin_lines(&target);
+  draw_target_set_stroke_color(&target, palette->back_line);
+  draw_back_lines(&target, mesh, screen_poss);
+  if (!palette->single_line_color)
+  {
+    draw_target_set_stroke_color(&target, palette->side_line);
+  }
+  draw_side_lines(&target, mesh, screen_poss);
+  if (!palette->single_line_color)
+  {
+    draw_target_set_stroke_color(&target, palette->front_line);
+  }
+  draw_front_lines(&target, mesh, screen_poss);
+  draw_target_end(&target);
+}
+
+// Every visible digit in one update: all fills, then each line pass across
+// the digits, so each colour is set once per frame.
+static void draw_digits_batched(GContext *ctx, const DigitRendererState *state, GPoint origin, GRect frame)
+{
+  static GPoint canvas_poss[DIGIT_RENDERER_DIGIT_COUNT][DIGIT_MESH_POINT_COUNT * 2];
+  const PolyLayerData *visible[DIGIT_RENDERER_DIGIT_COUNT];
+  const GPoint *screen_poss[DIGIT_RENDERER_DIGIT_COUNT];
+  int visible_count = 0;
+  const ResolvedPalette *palette = &state->palette;
+  DrawTarget target;
+
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  {
+    const PolyLayerData *data = &state->digit_data[i];
+    const GRect rect = glyph_rect(state, data);
+
+    if (data->hidden || data->mesh == NULL)
+    {
+      continue;
     }
+
+    visible[visible_count] = data;
+    screen_poss[visible_count] = offset_screen_poss(canvas_poss[visible_count], data,
+      GPoint(rect.origin.x - origin.x, rect.origin.y - origin.y));
+    ++visible_count;
+  }
+
+  draw_target_begin(&target, ctx, state, origin, frame);
+  draw_target_set_fill_color(&target, palette->face);
+  for (int i = 0; i < visible_count; ++i)
+  {
+    fill_digit(&target, state, visible[i], screen_poss[i]);
   }
+  draw_target_begin_lines(&target);
 
-  graphics_context_set_stroke_color(ctx, app_settings_get_line_color(renderer->state->settings));
-  for (int i = 0; i < poly->poly_data->contour_count; ++i)
+  // One colour over the fills draws the same pixels in any order: one pass per digit.
+  if (palette->single_line_color)
   {
-    const PolyPath *contour = &poly->poly_data->contours[i];
-    for (int j = 0; j < contour->point_count; ++j)
+    draw_target_set_stroke_color(&target, palette->front_line);
+    for (int i = 0; i < visible_count; ++i)
     {
-      int front_a = contour->point_idxs[j];
-      int front_b = contour->point_idxs[(j + 1) % contour->point_count];
+      draw_back_lines(&target, visible[i]->mesh, screen_poss[i]);
+      draw_side_lines(&target, visible[i]->mesh, screen_poss[i]);
+      draw_front_lines(&target, visible[i]->mesh, screen_poss[i]);
+    }
+    draw_target_end(&target);
+    return;
+  }
+
+  draw_target_set_stroke_color(&target, palette->back_line);
+  for (int i = 0; i < visible_count; ++i)
+  {
+    draw_back_lines(&target, visible[i]->mesh, screen_poss[i]);
+  }
+  draw_target_set_stroke_color(&target, palette->side_line);
+  for (int i = 0; i < visible_count; ++i)
+  {
+    draw_side_lines(&target, visible[i]->mesh, screen_poss[i]);
+  }
+  draw_target_set_stroke_color(&target, palette->front_line);
+  for (int i = 0; i < visible_count; ++i)
+  {
+    draw_front_lines(&target, visible[i]->mesh, screen_poss[i]);
+  }
+  draw_target_end(&target);
+}
+
+static void write_atlas_span(int y, int x0, int x1, DigitAtlasInk ink, void *context)
+{
+  AtlasGlyphLoad *load = context;
+
+  glyph_writer_fill_span(load->writer, y, x0, x1, load->inks[ink]);
+}
+
+static bool load_atlas_glyph(GlyphWriter *writer, void *context)
+{
+  AtlasGlyphLoad *load = context;
+  const ResolvedPalette *palette = &load->state->palette;
+
+  load->writer = writer;
+  load->inks[DIGIT_ATLAS_INK_NONE] = GColorClear;
+  load->inks[DIGIT_ATLAS_INK_FACE] = palette->face;
+  load->inks[DIGIT_ATLAS_INK_BACK_LINE] = palette->back_line;
+  load->inks[DIGIT_ATLAS_INK_SIDE_LINE] = palette->side_line;
+  load->inks[DIGIT_ATLAS_INK_FRONT_LINE] = palette->front_line;
+
+  return digit_atlas_decode(&load->state->atlas, load->digit, load->state->waypoint_index,
+    write_atlas_span, load);
+}
+
+// glyph_rect: where the full digit rect lies in ctx; screen_rect: the same on the framebuffer;
+// frame: the drawing layer's frame on the framebuffer.
+static void draw_digit(GContext *ctx, const PolyLayerData *data, GRect glyph_rect, GRect screen_rect,
+  GRect frame)
+{
+  DigitRendererState *state = data->renderer->state;
+  const int digit = data->mesh - digit_meshes;
+  LiveGlyphDraw draw = {
+    .data = data,
+    .origin = glyph_rect.origin,
+    .screen_offset = GPoint(screen_rect.origin.x - glyph_rect.origin.x, screen_rect.origin.y - glyph_rect.origin.y),
+    .screen_clip = frame,
+  };
+
+  if (state->waypoint_index < 0)
+  {
+    draw_poly_live(ctx, &draw);
+    return;
+  }
+
+  if (glyph_cache_draw(&state->glyph_cache, ctx, glyph_rect, digit, state->waypoint_index))
+  {
+    return;
+  }
+
+  AtlasGlyphLoad load = { .state = state, .digit = digit };
+
+  if (glyph_cache_load(&state->glyph_cache, digit, state->waypoint_index, load_atlas_glyph, &load) &&
+    glyph_cache_draw(&state->glyph_cache, ctx, glyph_rect, digit, state->waypoint_index))
+  {
+    return;
+  }
+
+  glyph_cache_render(&state->glyph_cache, ctx, glyph_rect, screen_rect, digit, state->waypoint_index,
+    draw_poly_live, &draw);
+}
+
+static void poly_layer_update_proc(Layer *layer, GContext* ctx)
+{
+  const PolyLayerData *data = poly_layer_get_data(layer);
+  const GSize size = data->renderer->state->digit_layer_size;
+  PROFILE_SCOPE(PROFILE_SECTION_UPDATE_PROC);
+
+  if (data->mesh == NULL)
+  {
+    return;
+  }
+
+  // The bounds origin keeps drawing coordinates relative to the full digit rect.
+  const GRect frame = layer_get_frame(layer);
+  const GRect bounds = layer_get_bounds(layer);
+
+  draw_digit(ctx, data, GRect(0, 0, size.w, size.h),
+    GRect(frame.origin.x + bounds.origin.x, frame.origin.y + bounds.origin.y, size.w, size.h), frame);
+  perf_log_frame_drawn();
+}
+
+static void canvas_update_proc(Layer *layer, GContext *ctx)
+{
+  const DigitRendererState *state = (*(DigitRenderer **)layer_get_data(layer))->state;
+  const GRect frame = layer_get_frame(layer);
+  const GRect bounds = layer_get_bounds(layer);
+  // where drawing coordinate (0, 0) lies in the parent, like the digit positions
+  const GPoint origin = GPoint(frame.origin.x + bounds.origin.x, frame.origin.y + bounds.origin.y);
+  PROFILE_SCOPE(PROFILE_SECTION_UPDATE_PROC);
+
+  if (state->waypoint_index < 0)
+  {
+    draw_digits_batched(ctx, state, origin, frame);
+    perf_log_frame_drawn();
+    return;
+  }
+
+  // Resting digits are cached glyph blits; there is nothing to batch.
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  {
+    const PolyLayerData *data = &state->digit_data[i];
+    const GRect rect = glyph_rect(state, data);
 
-      graphics_draw_line(ctx, screen_poss[front_a], screen_poss[front_b]);
+    if (data->hidden || data->mesh == NULL)
+    {
+      continue;
     }
+
+    draw_digit(ctx, data, GRect(rect.origin.x - origin.x, rect.origin.y - origin.y, rect.size.w, rect.size.h),
+      rect, frame);
   }
+  perf_log_frame_drawn();
 }
 
-static Layer* poly_layer_create(DigitRenderer *renderer, GSize size, Vec3 pos)
+static void init_poly_layer_data(DigitRenderer *renderer, PolyLayerData *data, Vec3 pos)
 {
-  Layer *layer;
-  PolyLayerData *data;
-  GPoint screen_pos;
+  data->renderer = renderer;
+  data->mesh = NULL;
+  data->pos = pos;
+  data->hidden = false;
+  update_model_view(renderer, data);
+  project_model_points(data->screen_poss, data);
+}
+
+static Layer* poly_layer_create(DigitRenderer *renderer, PolyLayerData *data)
+{
+  Layer *layer = layer_create_with_data(glyph_rect(renderer->state, data), sizeof(PolyLayerData *));
 
-  world_to_screen_pos(&screen_pos, renderer, &pos);
-  layer = layer_create_with_data(GRect(screen_pos.x - size.w / 2, screen_pos.y - size.h / 2, size.w, size.h),
-    sizeof(PolyLayerData));
   if (layer == NULL)
   {
     return NULL;
   }
 
-  data = layer_get_data(layer);
-  data->renderer = renderer;
-  data->poly_ref = NULL;
-  data->pos = pos;
+  *(PolyLayerData **)layer_get_data(layer) = data;
   layer_set_update_proc(layer, poly_layer_update_proc);
 
   return layer;
 }
 
+static Layer* canvas_layer_create(DigitRenderer *renderer, GRect frame)
+{
+  Layer *layer = layer_create_with_data(frame, sizeof(DigitRenderer *));
+
+  if (layer == NULL)
+  {
+    return NULL;
+  }
+
+  *(DigitRenderer **)layer_get_data(layer) = renderer;
+  layer_set_update_proc(layer, canvas_update_proc);
+
+  return layer;
+}
+
 static void destroy_digit_layers(DigitRendererState *state)
 {
   for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
@@ -309,19 +1079,65 @@ static void destroy_digit_layers(DigitRendererState *state)
     layer_destroy(state->digits[i]);
     state->digits[i] = NULL;
   }
+
+  if (state->canvas != NULL)
+  {
+    layer_destroy(state->canvas);
+    state->canvas = NULL;
+  }
 }
 
-static void poly_layer_set_poly_ref(Layer *layer, Poly* poly)
+static bool create_digit_layers(DigitRenderer *renderer, Layer *root_layer)
 {
-  ((PolyLayerData*)layer_get_data(layer))->poly_ref = poly;
-  layer_mark_dirty(layer);
+  DigitRendererState *state = renderer->state;
+
+  if (state->layout == DIGIT_RENDERER_SINGLE_LAYER)
+  {
+    state->canvas = canvas_layer_create(renderer, layer_get_bounds(root_layer));
+    if (state->canvas == NULL)
+    {
+      return false;
+    }
+
+    layer_add_child(root_layer, state->canvas);
+    return true;
+  }
+
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  {
+    state->digits[i] = poly_layer_create(renderer, &state->digit_data[i]);
+    if (state->digits[i] == NULL)
+    {
+      return false;
+    }
+
+    layer_add_child(root_layer, state->digits[i]);
+  }
+
+  return true;
+}
+
+static void mark_digit_layers_dirty(DigitRendererState *state)
+{
+  if (state->canvas != NULL)
+  {
+    layer_mark_dirty(state->canvas);
+  }
+
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  {
+    if (state->digits[i] != NULL)
+    {
+      layer_mark_dirty(state->digits[i]);
+    }
+  }
 }
 
 bool digit_renderer_init(DigitRenderer *renderer, Layer *root_layer,
-  const AppSettings *settings, const Mat4 *view_matrix)
+  const AppSettings *settings, const Mat4 *view_matrix, DigitRendererLayout layout)
 {
   renderer->state = NULL;
-  renderer->state = malloc(sizeof(DigitRendererState));
+  renderer->state = arena_alloc(sizeof(DigitRendererState));
   if (renderer->state == NULL)
   {
     return false;
@@ -329,32 +1145,44 @@ bool digit_renderer_init(DigitRenderer *renderer, Layer *root_layer,
 
   GRect bounds = layer_get_bounds(root_layer);
 
+  renderer->state->layout = layout;
+  renderer->state->canvas = NULL;
   renderer->state->settings = settings;
+  app_settings_resolve_palette(settings, &renderer->state->palette);
   renderer->state->view_matrix = view_matrix;
+  renderer->state->waypoint_index = -1;
+#ifdef DIGIT_RENDERER_FILL_MODES
+  renderer->state->fill_mode = DIGIT_FILL_FRAMEBUFFER;
+#endif
   configure_layout(renderer, bounds);
+  init_model_points(renderer->state);
 
-  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
+  if (!glyph_cache_init(&renderer->state->glyph_cache, renderer->state->digit_layer_size))
   {
-    renderer->state->digits[i] = NULL;
+    arena_release(renderer->state);
+    renderer->state = NULL;
+    return false;
   }
+  digit_atlas_init(&renderer->state->atlas, renderer->state->digit_layer_size);
 
-  for (int i = 0; i < (int)ARRAY_LENGTH(renderer->state->number_polys); ++i)
+  for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
   {
-    init_number_poly(renderer, &renderer->state->number_polys[i], i);
+    renderer->state->digits[i] = NULL;
   }
 
   for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
   {
-    renderer->state->digits[i] = poly_layer_create(renderer, renderer->state->digit_layer_size, renderer->state->digit_positions[i]);
-    if (renderer->state->digits[i] == NULL)
-    {
-      destroy_digit_layers(renderer->state);
-      free(renderer->state);
-      renderer->state = NULL;
-      return false;
-    }
+    init_poly_layer_data(renderer, &renderer->state->digit_data[i], renderer->state->digit_positions[i]);
+  }
 
-    layer_add_child(root_layer, renderer->state->digits[i]);
+  if (!create_digit_layers(renderer, root_layer))
+  {
+    destroy_digit_layers(renderer->state);
+    digit_atlas_deinit(&renderer->state->atlas);
+    glyph_cache_deinit(&renderer->state->glyph_cache);
+    arena_release(renderer->state);
+    renderer->state = NULL;
+    return false;
   }
 
   return true;
@@ -368,8 +1196,10 @@ void digit_renderer_deinit(DigitRenderer *renderer)
   }
 
   destroy_digit_layers(renderer->state);
+  digit_atlas_deinit(&renderer->state->atlas);
+  glyph_cache_deinit(&renderer->state->glyph_cache);
 
-  free(renderer->state);
+  arena_release(renderer->state);
   renderer->state = NULL;
 }
 
@@ -380,26 +1210,66 @@ void digit_renderer_set_digit(DigitRenderer *renderer, int index, int value, boo
     return;
   }
 
-  Layer *layer = renderer->state->digits[index];
+  DigitRendererState *state = renderer->state;
+  PolyLayerData *data = &state->digit_data[index];
+  Layer *layer = state->digits[index];
+
+  data->hidden = hidden;
+  if (!hidden)
+  {
+    data->mesh = &digit_meshes[value];
+  }
+
+  if (layer == NULL)
+  {
+    layer_mark_dirty(state->canvas);
+    return;
+  }
 
   layer_set_hidden(layer, hidden);
   if (!hidden)
   {
-    poly_layer_set_poly_ref(layer, &renderer->state->number_polys[value]);
+    update_layer_frame(state, layer);
+    layer_mark_dirty(layer);
   }
 }
 
-void digit_renderer_mark_all_dirty(DigitRenderer *renderer)
+void digit_renderer_update_view(DigitRenderer *renderer, int waypoint_index)
 {
   if (renderer->state == NULL)
   {
     return;
   }
 
+  DigitRendererState *state = renderer->state;
+
+  state->waypoint_index = waypoint_index;
+
   for (int i = 0; i < DIGIT_RENDERER_DIGIT_COUNT; ++i)
   {
-    layer_mark_dirty(renderer->state->digits[i]);
+    PolyLayerData *data = &state->digit_data[i];
+
+    update_model_view(renderer, data);
+    project_model_points(data->screen_poss, data);
+    if (state->digits[i] != NULL)
+    {
+      update_layer_frame(state, state->digits[i]);
+    }
+  }
+
+  mark_digit_layers_dirty(state);
+}
+
+void digit_renderer_mark_all_dirty(DigitRenderer *renderer)
+{
+  if (renderer->state == NULL)
+  {
+    return;
   }
+
+  app_settings_resolve_palette(renderer->state->settings, &renderer->state->palette);
+  glyph_cache_flush(&renderer->state->glyph_cache);
+  mark_digit_layers_dirty(renderer->state);
 }
 
 bool digit_renderer_is_ready(const DigitRenderer *renderer)
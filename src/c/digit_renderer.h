@@ -4,6 +4,14 @@
 #include "app_settings.h"
 #include "math_helper.h"
 
+typedef enum DigitRendererLayout
+{
+  // one Layer per digit
+  DIGIT_RENDERER_LAYER_PER_DIGIT,
+  // one Layer over the root; moving frames batch every fill and line pass across the digits
+  DIGIT_RENDERER_SINGLE_LAYER,
+} DigitRendererLayout;
+
 typedef struct DigitRendererState DigitRendererState;
 
 typedef struct DigitRenderer
@@ -12,8 +20,12 @@ typedef struct DigitRenderer
 } DigitRenderer;
 
 bool digit_renderer_init(DigitRenderer *renderer, Layer *root_layer,
-  const AppSettings *settings, const Mat4 *view_matrix);
+  const AppSettings *settings, const Mat4 *view_matrix, DigitRendererLayout layout);
 void digit_renderer_deinit(DigitRenderer *renderer);
 void digit_renderer_set_digit(DigitRenderer *renderer, int index, int value, bool hidden);
+// waypoint_index: camera waypoint while at rest (glyphs are cached), -1 otherwise.
+void digit_renderer_update_view(DigitRenderer *renderer, int waypoint_index);
+// Re-resolves the palette and redraws everything from scratch, dropping cached
+// glyphs (e.g. after a settings change).
 void digit_renderer_mark_all_dirty(DigitRenderer *renderer);
 bool digit_renderer_is_ready(const DigitRenderer *renderer);
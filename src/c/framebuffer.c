@@ -0,0 +1,147 @@
+#include "framebuffer.h"
+
+FramebufferRow framebuffer_get_row(GBitmap *bitmap, int y)
+{
+  const GBitmapFormat format = gbitmap_get_format(bitmap);
+  FramebufferRow row;
+
+  if (format == GBitmapFormat8BitCircular)
+  {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap, (uint16_t)y);
+
+    row.data = info.data;
+    row.min_x = info.min_x;
+    row.max_x = info.max_x;
+    row.one_bit = false;
+    return row;
+  }
+
+  row.data = gbitmap_get_data(bitmap) + y * gbitmap_get_bytes_per_row(bitmap);
+  row.min_x = 0;
+  row.max_x = (int16_t)(gbitmap_get_bounds(bitmap).size.w - 1);
+  row.one_bit = format == GBitmapFormat1Bit;
+  return row;
+}
+
+GRect framebuffer_clip_rect(const GBitmap *bitmap, GRect rect)
+{
+  const GRect bounds = gbitmap_get_bounds(bitmap);
+  const int x0 = rect.origin.x > bounds.origin.x ? rect.origin.x : bounds.origin.x;
+  const int y0 = rect.origin.y > bounds.origin.y ? rect.origin.y : bounds.origin.y;
+  const int x1 = rect.origin.x + rect.size.w < bounds.origin.x + bounds.size.w ?
+    rect.origin.x + rect.size.w : bounds.origin.x + bounds.size.w;
+  const int y1 = rect.origin.y + rect.size.h < bounds.origin.y + bounds.size.h ?
+    rect.origin.y + rect.size.h : bounds.origin.y + bounds.size.h;
+
+  if (x1 <= x0 || y1 <= y0)
+  {
+    return GRectZero;
+  }
+
+  return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+void framebuffer_row_fill(const FramebufferRow *row, int x0, int x1, GColor color)
+{
+  x0 = x0 > row->min_x ? x0 : row->min_x;
+  x1 = x1 < row->max_x ? x1 : row->max_x;
+  if (x0 > x1)
+  {
+    return;
+  }
+
+  if (!row->one_bit)
+  {
+    memset(row->data + x0, color.argb, (size_t)(x1 - x0 + 1));
+    return;
+  }
+
+  const uint8_t value = color.r + color.g + color.b >= 5 ? 0xFF : 0x00;
+  const int first_byte = x0 >> 3;
+  const int last_byte = x1 >> 3;
+  uint8_t first_mask = (uint8_t)(0xFF << (x0 & 7));
+  const uint8_t last_mask = (uint8_t)(0xFF >> (7 - (x1 & 7)));
+
+  if (first_byte == last_byte)
+  {
+    first_mask &= last_mask;
+  }
+
+  row->data[first_byte] = (uint8_t)((row->data[first_byte] & ~first_mask) | (value & first_mask));
+  if (first_byte == last_byte)
+  {
+    return;
+  }
+
+  memset(row->data + first_byte + 1, value, (size_t)(last_byte - first_byte - 1));
+  row->data[last_byte] = (uint8_t)((row->data[last_byte] & ~last_mask) | (value & last_mask));
+}
+
+//==============================================================================
+// lines
+
+#ifdef PBL_BW
+typedef struct LinePen
+{
+  uint8_t *data;
+  uint16_t bytes_per_row;
+  uint8_t ink;
+} LinePen;
+
+static inline void line_pen_put(LinePen *pen, int x, int y)
+{
+  uint8_t *byte = pen->data + y * pen->bytes_per_row + (x >> 3);
+  const uint8_t mask = (uint8_t)(1 << (x & 7));
+
+  *byte = (uint8_t)((*byte & ~mask) | (pen->ink & mask));
+}
+
+static bool rect_contains(GRect rect, GPoint point)
+{
+  return point.x >= rect.origin.x && point.y >= rect.origin.y &&
+    point.x < rect.origin.x + rect.size.w && point.y < rect.origin.y + rect.size.h;
+}
+
+void framebuffer_draw_line(GBitmap *framebuffer, GPoint p0, GPoint p1, GRect clip, GColor color)
+{
+  const int dx = abs(p1.x - p0.x);
+  const int dy = -abs(p1.y - p0.y);
+  const int sx = p0.x < p1.x ? 1 : -1;
+  const int sy = p0.y < p1.y ? 1 : -1;
+  // the clip is convex, so a line with both ends inside needs no per-pixel test
+  const bool inside = rect_contains(clip, p0) && rect_contains(clip, p1);
+  LinePen pen = {
+    .data = gbitmap_get_data(framebuffer),
+    .bytes_per_row = gbitmap_get_bytes_per_row(framebuffer),
+    .ink = color.r + color.g + color.b >= 5 ? 0xFF : 0x00,
+  };
+  int x = p0.x;
+  int y = p0.y;
+  int error = dx + dy;
+
+  for (;;)
+  {
+    if (inside || rect_contains(clip, GPoint(x, y)))
+    {
+      line_pen_put(&pen, x, y);
+    }
+    if (x == p1.x && y == p1.y)
+    {
+      break;
+    }
+
+    const int error2 = 2 * error;
+
+    if (error2 >= dy)
+    {
+      error += dy;
+      x += sx;
+    }
+    if (error2 <= dx)
+    {
+      error += dx;
+      y += sy;
+    }
+  }
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// Row access to captured framebuffers and blank GBitmaps in GBitmapFormat1Bit,
+// GBitmapFormat8Bit and GBitmapFormat8BitCircular. data always addresses
+// column 0; only min_x..max_x of a row are backed by memory.
+
+typedef struct FramebufferRow
+{
+  uint8_t *data;
+  int16_t min_x;
+  int16_t max_x;
+  bool one_bit;
+} FramebufferRow;
+
+FramebufferRow framebuffer_get_row(GBitmap *bitmap, int y);
+// Intersection of rect with the bitmap bounds.
+GRect framebuffer_clip_rect(const GBitmap *bitmap, GRect rect);
+// Pixels x0..x1 (inclusive, clipped to the row) get color; 1-bit rows take
+// white for colors at least half bright, like the display.
+void framebuffer_row_fill(const FramebufferRow *row, int x0, int x1, GColor color);
+#ifdef PBL_BW
+// What graphics_draw_line draws at stroke width 1, both ends included,
+// clipped to clip, into the captured 1-bit framebuffer. Black and white only:
+// colour platforms antialias their lines, which this does not.
+void framebuffer_draw_line(GBitmap *framebuffer, GPoint p0, GPoint p1, GRect clip, GColor color);
+#endif
+
+static inline GColor framebuffer_row_get_pixel(const FramebufferRow *row, int x)
+{
+  if (row->one_bit)
+  {
+    return (row->data[x >> 3] & (1 << (x & 7))) ? GColorWhite : GColorBlack;
+  }
+
+  return (GColor8){ .argb = row->data[x] };
+}
+
+static inline void framebuffer_row_set_pixel(const FramebufferRow *row, int x, GColor color)
+{
+  if (row->one_bit)
+  {
+    const uint8_t mask = (uint8_t)(1 << (x & 7));
+
+    if (gcolor_equal(color, GColorWhite))
+    {
+      row->data[x >> 3] |= mask;
+    }
+    else
+    {
+      row->data[x >> 3] &= (uint8_t)~mask;
+    }
+    return;
+  }
+
+  row->data[x] = color.argb;
+}
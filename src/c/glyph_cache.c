@@ -0,0 +1,525 @@
+#include "glyph_cache.h"
+#include "arena.h"
+#include "framebuffer.h"
+
+// Can be overridden from the build; 0 disables the cache.
+#if defined(GLYPH_CACHE_BUDGET_BYTES)
+#elif defined(PBL_PLATFORM_APLITE)
+#define GLYPH_CACHE_BUDGET_BYTES (6 * 1024)
+#elif defined(PBL_BW)
+#define GLYPH_CACHE_BUDGET_BYTES (8 * 1024)
+#elif defined(PBL_PLATFORM_BASALT) || defined(PBL_PLATFORM_CHALK)
+#define GLYPH_CACHE_BUDGET_BYTES (24 * 1024)
+#else
+#define GLYPH_CACHE_BUDGET_BYTES (48 * 1024)
+#endif
+
+#define GLYPH_CACHE_MAX_ENTRIES 12
+
+// 1-bit glyphs are a pair of masks drawn with GCompOpOr / GCompOpClear, color
+// glyphs one 8-bit bitmap whose alpha is the coverage.
+#ifdef PBL_BW
+#define GLYPH_BITMAP_FORMAT GBitmapFormat1Bit
+#define GLYPH_INK_WHITE 0
+#define GLYPH_INK_BLACK 1
+#define GLYPH_BITMAPS_PER_ENTRY 2
+#else
+#define GLYPH_BITMAP_FORMAT GBitmapFormat8Bit
+#define GLYPH_BITMAPS_PER_ENTRY 1
+#endif
+
+typedef struct GlyphCacheEntry
+{
+  GBitmap *bitmaps[GLYPH_BITMAPS_PER_ENTRY];
+  int8_t digit;
+  int8_t waypoint;
+  uint32_t last_used;
+} GlyphCacheEntry;
+
+struct GlyphWriter
+{
+  GlyphCacheEntry *entry;
+};
+
+struct GlyphCacheState
+{
+  GSize glyph_size;
+  int capacity;
+  uint32_t use_counter;
+  // framebuffer contents under a glyph while it is being captured
+  GBitmap *scratch;
+  GlyphCacheEntry entries[GLYPH_CACHE_MAX_ENTRIES];
+};
+
+static size_t glyph_bitmap_bytes(GSize size)
+{
+#ifdef PBL_BW
+  return (size_t)((size.w + 31) / 32) * 4 * size.h;
+#else
+  return (size_t)size.w * size.h;
+#endif
+}
+
+// Empties the entry; its bitmaps stay for the next glyph.
+static void entry_release(GlyphCacheEntry *entry)
+{
+  entry->digit = -1;
+  entry->waypoint = -1;
+}
+
+static void entry_destroy_bitmaps(GlyphCacheEntry *entry)
+{
+  for (int i = 0; i < GLYPH_BITMAPS_PER_ENTRY; ++i)
+  {
+    if (entry->bitmaps[i] != NULL)
+    {
+      gbitmap_destroy(entry->bitmaps[i]);
+      entry->bitmaps[i] = NULL;
+    }
+  }
+}
+
+static bool entry_create_bitmaps(GlyphCacheEntry *entry, GSize glyph_size)
+{
+  for (int i = 0; i < GLYPH_BITMAPS_PER_ENTRY; ++i)
+  {
+    entry->bitmaps[i] = gbitmap_create_blank(glyph_size, GLYPH_BITMAP_FORMAT);
+    if (entry->bitmaps[i] == NULL)
+    {
+      entry_destroy_bitmaps(entry);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static GlyphCacheEntry *find_entry(GlyphCacheState *state, int digit, int waypoint)
+{
+  for (int i = 0; i < state->capacity; ++i)
+  {
+    if (state->entries[i].digit == digit && state->entries[i].waypoint == waypoint)
+    {
+      return &state->entries[i];
+    }
+  }
+
+  return NULL;
+}
+
+static GlyphCacheEntry *claim_entry(GlyphCacheState *state, int digit, int waypoint)
+{
+  GlyphCacheEntry *entry = find_entry(state, digit, waypoint);
+
+  if (entry == NULL)
+  {
+    for (int i = 0; i < state->capacity; ++i)
+    {
+      if (entry == NULL || state->entries[i].digit < 0 ||
+        (entry->digit >= 0 && state->entries[i].last_used < entry->last_used))
+      {
+        entry = &state->entries[i];
+      }
+    }
+  }
+
+  if (entry == NULL)
+  {
+    return NULL;
+  }
+
+  entry->digit = digit;
+  entry->waypoint = waypoint;
+  entry->last_used = ++state->use_counter;
+  return entry;
+}
+
+static void draw_entry(GContext *ctx, const GlyphCacheEntry *entry, GRect bounds)
+{
+#ifdef PBL_BW
+  graphics_context_set_compositing_mode(ctx, GCompOpOr);
+  graphics_draw_bitmap_in_rect(ctx, entry->bitmaps[GLYPH_INK_WHITE], bounds);
+  graphics_context_set_compositing_mode(ctx, GCompOpClear);
+  graphics_draw_bitmap_in_rect(ctx, entry->bitmaps[GLYPH_INK_BLACK], bounds);
+#else
+  graphics_context_set_compositing_mode(ctx, GCompOpSet);
+  graphics_draw_bitmap_in_rect(ctx, entry->bitmaps[0], bounds);
+#endif
+  graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+}
+
+//==============================================================================
+// capture
+//
+// The glyph is drawn twice, over a white and then a black preset of its
+// region. Pixels that come out the same both times are covered by the glyph;
+// the difference of the two gives the coverage of blended (antialiased) ones.
+
+static void fill_region(GBitmap *framebuffer, GRect clip, GColor color)
+{
+  for (int y = clip.origin.y; y < clip.origin.y + clip.size.h; ++y)
+  {
+    const FramebufferRow row = framebuffer_get_row(framebuffer, y);
+    const int x0 = clip.origin.x > row.min_x ? clip.origin.x : row.min_x;
+    const int x1 = clip.origin.x + clip.size.w - 1 < row.max_x ? clip.origin.x + clip.size.w - 1 : row.max_x;
+
+    for (int x = x0; x <= x1; ++x)
+    {
+      framebuffer_row_set_pixel(&row, x, color);
+    }
+  }
+}
+
+static void copy_region(GBitmap *framebuffer, GBitmap *glyph, GRect clip, GPoint glyph_origin,
+  bool to_framebuffer)
+{
+  for (int y = clip.origin.y; y < clip.origin.y + clip.size.h; ++y)
+  {
+    const FramebufferRow row = framebuffer_get_row(framebuffer, y);
+    const FramebufferRow glyph_row = framebuffer_get_row(glyph, y - glyph_origin.y);
+    const int x0 = clip.origin.x > row.min_x ? clip.origin.x : row.min_x;
+    const int x1 = clip.origin.x + clip.size.w - 1 < row.max_x ? clip.origin.x + clip.size.w - 1 : row.max_x;
+
+    for (int x = x0; x <= x1; ++x)
+    {
+      if (to_framebuffer)
+      {
+        framebuffer_row_set_pixel(&row, x, framebuffer_row_get_pixel(&glyph_row, x - glyph_origin.x));
+      }
+      else
+      {
+        framebuffer_row_set_pixel(&glyph_row, x - glyph_origin.x, framebuffer_row_get_pixel(&row, x));
+      }
+    }
+  }
+}
+
+static void clear_bitmap(GBitmap *bitmap)
+{
+  const GRect bounds = gbitmap_get_bounds(bitmap);
+
+  memset(gbitmap_get_data(bitmap), 0, (size_t)gbitmap_get_bytes_per_row(bitmap) * bounds.size.h);
+}
+
+#ifndef PBL_BW
+static uint8_t channel_coverage(uint8_t over_white, uint8_t over_black)
+{
+  return over_white > over_black ? (uint8_t)(3 - (over_white - over_black)) : 3;
+}
+
+// over_black = alpha * color / 3, solved for color.
+static uint8_t channel_unblend(uint8_t over_black, uint8_t alpha)
+{
+  const int color = (over_black * 3 + alpha / 2) / alpha;
+  return (uint8_t)(color > 3 ? 3 : color);
+}
+#endif
+
+// Combines the white preset pass (already in the entry) with the black preset
+// pass in the framebuffer.
+static void resolve_coverage(GlyphCacheEntry *entry, GBitmap *framebuffer, GRect clip, GPoint glyph_origin)
+{
+  for (int y = clip.origin.y; y < clip.origin.y + clip.size.h; ++y)
+  {
+    const FramebufferRow row = framebuffer_get_row(framebuffer, y);
+    const int x0 = clip.origin.x > row.min_x ? clip.origin.x : row.min_x;
+    const int x1 = clip.origin.x + clip.size.w - 1 < row.max_x ? clip.origin.x + clip.size.w - 1 : row.max_x;
+#ifdef PBL_BW
+    const FramebufferRow white_row = framebuffer_get_row(entry->bitmaps[GLYPH_INK_WHITE], y - glyph_origin.y);
+    const FramebufferRow black_row = framebuffer_get_row(entry->bitmaps[GLYPH_INK_BLACK], y - glyph_origin.y);
+
+    for (int x = x0; x <= x1; ++x)
+    {
+      const int glyph_x = x - glyph_origin.x;
+      const bool over_white = gcolor_equal(framebuffer_row_get_pixel(&white_row, glyph_x), GColorWhite);
+      const bool over_black = gcolor_equal(framebuffer_row_get_pixel(&row, x), GColorWhite);
+
+      framebuffer_row_set_pixel(&white_row, glyph_x, over_white && over_black ? GColorWhite : GColorBlack);
+      framebuffer_row_set_pixel(&black_row, glyph_x, !over_white && !over_black ? GColorWhite : GColorBlack);
+    }
+#else
+    const FramebufferRow glyph_row = framebuffer_get_row(entry->bitmaps[0], y - glyph_origin.y);
+
+    for (int x = x0; x <= x1; ++x)
+    {
+      const int glyph_x = x - glyph_origin.x;
+      const GColor over_white = framebuffer_row_get_pixel(&glyph_row, glyph_x);
+      const GColor over_black = framebuffer_row_get_pixel(&row, x);
+      const uint8_t coverage_r = channel_coverage(over_white.r, over_black.r);
+      const uint8_t coverage_g = channel_coverage(over_white.g, over_black.g);
+      const uint8_t coverage_b = channel_coverage(over_white.b, over_black.b);
+      uint8_t alpha = coverage_r < coverage_g ? coverage_r : coverage_g;
+      GColor color = GColorClear;
+
+      alpha = coverage_b < alpha ? coverage_b : alpha;
+      if (alpha > 0)
+      {
+        color.a = alpha;
+        color.r = channel_unblend(over_black.r, alpha);
+        color.g = channel_unblend(over_black.g, alpha);
+        color.b = channel_unblend(over_black.b, alpha);
+      }
+
+      framebuffer_row_set_pixel(&glyph_row, glyph_x, color);
+    }
+#endif
+  }
+}
+
+static bool capture_pass(GContext *ctx, GlyphCacheState *state, GlyphCacheEntry *entry, GRect screen_rect,
+  bool first_pass, GlyphDrawHandler draw_handler, void *context)
+{
+  const GPoint glyph_origin = screen_rect.origin;
+  GBitmap *framebuffer = graphics_capture_frame_buffer(ctx);
+  GRect clip;
+
+  if (framebuffer == NULL)
+  {
+    return false;
+  }
+
+  clip = framebuffer_clip_rect(framebuffer, screen_rect);
+  if (first_pass)
+  {
+    copy_region(framebuffer, state->scratch, clip, glyph_origin, false);
+    fill_region(framebuffer, clip, GColorWhite);
+  }
+  else
+  {
+#ifdef PBL_BW
+    copy_region(framebuffer, entry->bitmaps[GLYPH_INK_WHITE], clip, glyph_origin, false);
+#else
+    copy_region(framebuffer, entry->bitmaps[0], clip, glyph_origin, false);
+#endif
+    fill_region(framebuffer, clip, GColorBlack);
+  }
+  graphics_release_frame_buffer(ctx, framebuffer);
+
+  draw_handler(ctx, context);
+  return true;
+}
+
+static bool capture_glyph(GContext *ctx, GlyphCacheState *state, GlyphCacheEntry *entry, GRect screen_rect,
+  GlyphDrawHandler draw_handler, void *context)
+{
+  GBitmap *framebuffer;
+  GRect clip;
+
+  for (int i = 0; i < GLYPH_BITMAPS_PER_ENTRY; ++i)
+  {
+    clear_bitmap(entry->bitmaps[i]);
+  }
+
+  if (!capture_pass(ctx, state, entry, screen_rect, true, draw_handler, context) ||
+    !capture_pass(ctx, state, entry, screen_rect, false, draw_handler, context))
+  {
+    return false;
+  }
+
+  framebuffer = graphics_capture_frame_buffer(ctx);
+  if (framebuffer == NULL)
+  {
+    return false;
+  }
+
+  clip = framebuffer_clip_rect(framebuffer, screen_rect);
+  resolve_coverage(entry, framebuffer, clip, screen_rect.origin);
+  copy_region(framebuffer, state->scratch, clip, screen_rect.origin, true);
+  graphics_release_frame_buffer(ctx, framebuffer);
+  return true;
+}
+
+//==============================================================================
+
+bool glyph_cache_init(GlyphCache *cache, GSize glyph_size)
+{
+  const size_t bitmap_bytes = glyph_bitmap_bytes(glyph_size);
+  GlyphCacheState *state;
+
+  cache->state = NULL;
+  state = arena_alloc(sizeof(GlyphCacheState));
+  if (state == NULL)
+  {
+    return false;
+  }
+
+  state->glyph_size = glyph_size;
+  state->use_counter = 0;
+  state->capacity = 0;
+  if (bitmap_bytes > 0 && bitmap_bytes < GLYPH_CACHE_BUDGET_BYTES)
+  {
+    state->capacity = (int)((GLYPH_CACHE_BUDGET_BYTES - bitmap_bytes) / (bitmap_bytes * GLYPH_BITMAPS_PER_ENTRY));
+  }
+  if (state->capacity > GLYPH_CACHE_MAX_ENTRIES)
+  {
+    state->capacity = GLYPH_CACHE_MAX_ENTRIES;
+  }
+
+  for (int i = 0; i < GLYPH_CACHE_MAX_ENTRIES; ++i)
+  {
+    for (int j = 0; j < GLYPH_BITMAPS_PER_ENTRY; ++j)
+    {
+      state->entries[i].bitmaps[j] = NULL;
+    }
+    entry_release(&state->entries[i]);
+    state->entries[i].last_used = 0;
+  }
+
+  state->scratch = NULL;
+  if (state->capacity > 0)
+  {
+    state->scratch = gbitmap_create_blank(glyph_size, GLYPH_BITMAP_FORMAT);
+    if (state->scratch == NULL)
+    {
+      state->capacity = 0;
+    }
+  }
+
+  // Every bitmap up front, so filling and evicting entries never allocates.
+  for (int i = 0; i < state->capacity; ++i)
+  {
+    if (!entry_create_bitmaps(&state->entries[i], glyph_size))
+    {
+      state->capacity = i;
+    }
+  }
+
+  cache->state = state;
+  return true;
+}
+
+void glyph_cache_deinit(GlyphCache *cache)
+{
+  if (cache->state == NULL)
+  {
+    return;
+  }
+
+  for (int i = 0; i < GLYPH_CACHE_MAX_ENTRIES; ++i)
+  {
+    entry_destroy_bitmaps(&cache->state->entries[i]);
+  }
+  if (cache->state->scratch != NULL)
+  {
+    gbitmap_destroy(cache->state->scratch);
+  }
+  arena_release(cache->state);
+  cache->state = NULL;
+}
+
+void glyph_cache_flush(GlyphCache *cache)
+{
+  if (cache->state == NULL)
+  {
+    return;
+  }
+
+  for (int i = 0; i < GLYPH_CACHE_MAX_ENTRIES; ++i)
+  {
+    entry_release(&cache->state->entries[i]);
+  }
+}
+
+bool glyph_cache_draw(GlyphCache *cache, GContext *ctx, GRect bounds, int digit, int waypoint)
+{
+  GlyphCacheEntry *entry;
+
+  if (cache->state == NULL)
+  {
+    return false;
+  }
+
+  entry = find_entry(cache->state, digit, waypoint);
+  if (entry == NULL)
+  {
+    return false;
+  }
+
+  entry->last_used = ++cache->state->use_counter;
+  draw_entry(ctx, entry, bounds);
+  return true;
+}
+
+void glyph_cache_render(GlyphCache *cache, GContext *ctx, GRect bounds, GRect screen_rect,
+  int digit, int waypoint, GlyphDrawHandler draw_handler, void *context)
+{
+  GlyphCacheEntry *entry = NULL;
+
+  if (cache->state != NULL && cache->state->capacity > 0)
+  {
+    entry = claim_entry(cache->state, digit, waypoint);
+  }
+
+  if (entry == NULL)
+  {
+    draw_handler(ctx, context);
+    return;
+  }
+
+  if (!capture_glyph(ctx, cache->state, entry, screen_rect, draw_handler, context))
+  {
+    // Only fails when the framebuffer could not be captured, before any preset.
+    entry_release(entry);
+    draw_handler(ctx, context);
+    return;
+  }
+
+  draw_entry(ctx, entry, bounds);
+}
+
+bool glyph_cache_load(GlyphCache *cache, int digit, int waypoint, GlyphLoadHandler load_handler,
+  void *context)
+{
+  GlyphWriter writer = { .entry = NULL };
+
+  if (cache->state != NULL && cache->state->capacity > 0)
+  {
+    writer.entry = claim_entry(cache->state, digit, waypoint);
+  }
+
+  if (writer.entry == NULL)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < GLYPH_BITMAPS_PER_ENTRY; ++i)
+  {
+    clear_bitmap(writer.entry->bitmaps[i]);
+  }
+
+  if (!load_handler(&writer, context))
+  {
+    entry_release(writer.entry);
+    return false;
+  }
+
+  return true;
+}
+
+void glyph_writer_fill_span(GlyphWriter *writer, int y, int x0, int x1, GColor color)
+{
+#ifdef PBL_BW
+  const bool covered = color.a != 0;
+  const bool white = covered && gcolor_equal(color, GColorWhite);
+  const FramebufferRow white_row = framebuffer_get_row(writer->entry->bitmaps[GLYPH_INK_WHITE], y);
+  const FramebufferRow black_row = framebuffer_get_row(writer->entry->bitmaps[GLYPH_INK_BLACK], y);
+
+  for (int x = x0; x <= x1; ++x)
+  {
+    framebuffer_row_set_pixel(&white_row, x, white ? GColorWhite : GColorBlack);
+    framebuffer_row_set_pixel(&black_row, x, covered && !white ? GColorWhite : GColorBlack);
+  }
+#else
+  const FramebufferRow row = framebuffer_get_row(writer->entry->bitmaps[0], y);
+
+  for (int x = x0; x <= x1; ++x)
+  {
+    framebuffer_row_set_pixel(&row, x, color);
+  }
+#endif
+}
+
+int glyph_cache_get_capacity(const GlyphCache *cache)
+{
+  return cache->state != NULL ? cache->state->capacity : 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// LRU cache of rendered digit glyphs keyed by (digit value, camera waypoint),
+// sized to a per-platform memory budget. Glyphs keep per-pixel coverage, so a
+// cached glyph composites over overlapping neighbours exactly like the live
+// draw it was captured from.
+
+typedef void (*GlyphDrawHandler)(GContext *ctx, void *context);
+
+typedef struct GlyphWriter GlyphWriter;
+// Fills a glyph being loaded; false abandons it.
+typedef bool (*GlyphLoadHandler)(GlyphWriter *writer, void *context);
+
+typedef struct GlyphCacheState GlyphCacheState;
+
+typedef struct GlyphCache
+{
+  GlyphCacheState *state;
+} GlyphCache;
+
+bool glyph_cache_init(GlyphCache *cache, GSize glyph_size);
+void glyph_cache_deinit(GlyphCache *cache);
+void glyph_cache_flush(GlyphCache *cache);
+// Draws a cached glyph into bounds, or returns false on a miss.
+bool glyph_cache_draw(GlyphCache *cache, GContext *ctx, GRect bounds, int digit, int waypoint);
+// Runs draw_handler and stores its result. screen_rect is where bounds lies on
+// the framebuffer.
+void glyph_cache_render(GlyphCache *cache, GContext *ctx, GRect bounds, GRect screen_rect,
+  int digit, int waypoint, GlyphDrawHandler draw_handler, void *context);
+// Stores a glyph written by load_handler instead of a rendered one.
+bool glyph_cache_load(GlyphCache *cache, int digit, int waypoint, GlyphLoadHandler load_handler,
+  void *context);
+// Sets pixels x0..x1 (inclusive) of row y of a loading glyph; GColorClear
+// leaves them uncovered.
+void glyph_writer_fill_span(GlyphWriter *writer, int y, int x0, int x1, GColor color);
+int glyph_cache_get_capacity(const GlyphCache *cache);
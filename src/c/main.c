@@ -3,6 +3,7 @@
 #include "camera_controller.h"
 #include "clock_digits.h"
 #include "digit_renderer.h"
+#include "perf_log.h"
 
 //==============================================================================
 // app state
@@ -19,7 +20,8 @@ static void invalidate_digit_layers(void *context)
     return;
   }
 
-  digit_renderer_mark_all_dirty(&s_digit_renderer);
+  digit_renderer_update_view(&s_digit_renderer,
+    camera_controller_get_waypoint_index(&s_camera_controller));
 }
 
 //==============================================================================
@@ -50,6 +52,7 @@ static void apply_visual_settings(void)
 
 static void inbox_received_callback(DictionaryIterator *iterator, void *context)
 {
+  perf_log_apply_message(iterator);
   if (app_settings_apply_message(&s_settings, iterator))
   {
     app_settings_save(&s_settings);
@@ -125,11 +128,13 @@ static void window_load(Window* window)
   }
 
   if (!digit_renderer_init(&s_digit_renderer, root_layer, &s_settings,
-    camera_controller_get_view_matrix(&s_camera_controller)))
+    camera_controller_get_view_matrix(&s_camera_controller), DIGIT_RENDERER_LAYER_PER_DIGIT))
   {
     APP_LOG(APP_LOG_LEVEL_ERROR, "Failed to initialize digit renderer");
     return;
   }
+  // the first frame draws at the camera's resting waypoint, from the atlas
+  invalidate_digit_layers(NULL);
 
   s_has_current_digits = false;
 
@@ -151,6 +156,7 @@ static void window_unload(Window *window)
 
 static void handle_init()
 {
+  perf_log_init();
   app_settings_load(&s_settings);
 
   s_window = window_create();
@@ -169,6 +175,7 @@ static void handle_init()
 static void handle_deinit(void)
 {
   window_destroy(s_window);
+  perf_log_deinit();
 }
 
 int main(void)
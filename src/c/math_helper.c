@@ -16,6 +16,49 @@ float q_sqrt(const float x)
   return x * u.x * (1.5f - xhalf * u.x * u.x);
 }
 
+#ifdef MATH_FIXED_POINT
+
+static uint32_t isqrt64(uint64_t x)
+{
+  uint64_t result = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > x)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (x >= result + bit)
+    {
+      x -= result + bit;
+      result = (result >> 1) + bit;
+    }
+    else
+    {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)result;
+}
+
+Scalar scalar_sqrt(const Scalar x)
+{
+  return x > 0 ? (Scalar)isqrt64((uint64_t)x << SCALAR_FRACTION_BITS) : 0;
+}
+
+#else
+
+Scalar scalar_sqrt(const Scalar x)
+{
+  return q_sqrt(x);
+}
+
+#endif
+
 void vec3_plus(Vec3* out_v, const Vec3* v1, const Vec3* v2)
 {
   out_v->x = v1->x + v2->x;
@@ -30,28 +73,35 @@ void vec3_minus(Vec3* out_v, const Vec3* v1, const Vec3* v2)
   out_v->z = v1->z - v2->z;
 }
 
-void vec3_multiply(Vec3* out_v, const Vec3* v1, float multiplier)
+void vec3_multiply(Vec3* out_v, const Vec3* v1, Scalar multiplier)
 {
-  out_v->x = v1->x * multiplier;
-  out_v->y = v1->y * multiplier;
-  out_v->z = v1->z * multiplier;
+  out_v->x = scalar_mul(v1->x, multiplier);
+  out_v->y = scalar_mul(v1->y, multiplier);
+  out_v->z = scalar_mul(v1->z, multiplier);
 }
 
-float vec3_length(const Vec3* v)
+Scalar vec3_length(const Vec3* v)
 {
-  return q_sqrt(v->x * v->x + v->y * v->y + v->z * v->z);
+  ScalarWide length_sq = scalar_mul_wide(v->x, v->x) + scalar_mul_wide(v->y, v->y) + scalar_mul_wide(v->z, v->z);
+
+#ifdef MATH_FIXED_POINT
+  // sqrt of a Q32.32 square is already Q16.16
+  return (Scalar)isqrt64((uint64_t)length_sq);
+#else
+  return q_sqrt(length_sq);
+#endif
 }
 
-float vec3_normalize(Vec3* v)
+Scalar vec3_normalize(Vec3* v)
 {
-  float length = vec3_length(v);
+  Scalar length = vec3_length(v);
 
-  if (length > 1e-06)
+  if (length > SCALAR_EPSILON)
   {
-    float inv_length = 1.0f / length;
-    v->x *= inv_length;
-    v->y *= inv_length;
-    v->z *= inv_length;
+    Scalar inv_length = scalar_div(SCALAR_ONE, length);
+    v->x = scalar_mul(v->x, inv_length);
+    v->y = scalar_mul(v->y, inv_length);
+    v->z = scalar_mul(v->z, inv_length);
   }
 
   return length;
@@ -59,16 +109,16 @@ float vec3_normalize(Vec3* v)
 
 void vec3_cross_product(Vec3* out_v, const Vec3* v1, const Vec3* v2)
 {
-  out_v->x = v1->y * v2->z - v1->z * v2->y;
-  out_v->y = v1->z * v2->x - v1->x * v2->z;
-  out_v->z = v1->x * v2->y - v1->y * v2->x;
+  out_v->x = scalar_narrow(scalar_mul_wide(v1->y, v2->z) - scalar_mul_wide(v1->z, v2->y));
+  out_v->y = scalar_narrow(scalar_mul_wide(v1->z, v2->x) - scalar_mul_wide(v1->x, v2->z));
+  out_v->z = scalar_narrow(scalar_mul_wide(v1->x, v2->y) - scalar_mul_wide(v1->y, v2->x));
 }
 
 void mat4_set(Mat4* m,
-  float m00, float m01, float m02, float m03,
-  float m10, float m11, float m12, float m13,
-  float m20, float m21, float m22, float m23,
-  float m30, float m31, float m32, float m33)
+  Scalar m00, Scalar m01, Scalar m02, Scalar m03,
+  Scalar m10, Scalar m11, Scalar m12, Scalar m13,
+  Scalar m20, Scalar m21, Scalar m22, Scalar m23,
+  Scalar m30, Scalar m31, Scalar m32, Scalar m33)
 {
   m->m[_00] = m00; m->m[_01] = m01; m->m[_02] = m02; m->m[_03] = m03;
   m->m[_10] = m10; m->m[_11] = m11; m->m[_12] = m12; m->m[_13] = m13;
@@ -78,42 +128,106 @@ void mat4_set(Mat4* m,
 
 void mat4_multiply(Mat4* out_m, const Mat4* m1, const Mat4* m2)
 {
-  out_m->m[_00] = m1->m[_00] * m2->m[_00] + m1->m[_01] * m2->m[_10] + m1->m[_02] * m2->m[_20] + m1->m[_03] * m2->m[_30];
-  out_m->m[_01] = m1->m[_00] * m2->m[_01] + m1->m[_01] * m2->m[_11] + m1->m[_02] * m2->m[_21] + m1->m[_03] * m2->m[_31];
-  out_m->m[_02] = m1->m[_00] * m2->m[_02] + m1->m[_01] * m2->m[_12] + m1->m[_02] * m2->m[_22] + m1->m[_03] * m2->m[_32];
-  out_m->m[_03] = m1->m[_00] * m2->m[_03] + m1->m[_01] * m2->m[_13] + m1->m[_02] * m2->m[_23] + m1->m[_03] * m2->m[_33];
+  for (int col = 0; col < 4; ++col)
+  {
+    for (int row = 0; row < 4; ++row)
+    {
+      out_m->m[col * 4 + row] = scalar_narrow(
+        scalar_mul_wide(m1->m[0 * 4 + row], m2->m[col * 4 + 0]) +
+        scalar_mul_wide(m1->m[1 * 4 + row], m2->m[col * 4 + 1]) +
+        scalar_mul_wide(m1->m[2 * 4 + row], m2->m[col * 4 + 2]) +
+        scalar_mul_wide(m1->m[3 * 4 + row], m2->m[col * 4 + 3]));
+    }
+  }
+}
 
-  out_m->m[_10] = m1->m[_10] * m2->m[_00] + m1->m[_11] * m2->m[_10] + m1->m[_12] * m2->m[_20] + m1->m[_13] * m2->m[_30];
-  out_m->m[_11] = m1->m[_10] * m2->m[_01] + m1->m[_11] * m2->m[_11] + m1->m[_12] * m2->m[_21] + m1->m[_13] * m2->m[_31];
-  out_m->m[_12] = m1->m[_10] * m2->m[_02] + m1->m[_11] * m2->m[_12] + m1->m[_12] * m2->m[_22] + m1->m[_13] * m2->m[_32];
-  out_m->m[_13] = m1->m[_10] * m2->m[_03] + m1->m[_11] * m2->m[_13] + m1->m[_12] * m2->m[_23] + m1->m[_13] * m2->m[_33];
+static Scalar mat4_row_dot(const Mat4* m, int row, const Vec3* v)
+{
+  return scalar_narrow(
+    scalar_mul_wide(m->m[_00 + row], v->x) +
+    scalar_mul_wide(m->m[_01 + row], v->y) +
+    scalar_mul_wide(m->m[_02 + row], v->z) +
+    scalar_widen(m->m[_03 + row]));
+}
 
-  out_m->m[_20] = m1->m[_20] * m2->m[_00] + m1->m[_21] * m2->m[_10] + m1->m[_22] * m2->m[_20] + m1->m[_23] * m2->m[_30];
-  out_m->m[_21] = m1->m[_20] * m2->m[_01] + m1->m[_21] * m2->m[_11] + m1->m[_22] * m2->m[_21] + m1->m[_23] * m2->m[_31];
-  out_m->m[_22] = m1->m[_20] * m2->m[_02] + m1->m[_21] * m2->m[_12] + m1->m[_22] * m2->m[_22] + m1->m[_23] * m2->m[_32];
-  out_m->m[_23] = m1->m[_20] * m2->m[_03] + m1->m[_21] * m2->m[_13] + m1->m[_22] * m2->m[_23] + m1->m[_23] * m2->m[_33];
+void mat4_multiply_vec3(Vec3* out_v, const Mat4* m, const Vec3* v)
+{
+  Scalar inv_w = scalar_div(SCALAR_ONE, mat4_row_dot(m, 3, v));
 
-  out_m->m[_30] = m1->m[_30] * m2->m[_00] + m1->m[_31] * m2->m[_10] + m1->m[_32] * m2->m[_20] + m1->m[_33] * m2->m[_30];
-  out_m->m[_31] = m1->m[_30] * m2->m[_01] + m1->m[_31] * m2->m[_11] + m1->m[_32] * m2->m[_21] + m1->m[_33] * m2->m[_31];
-  out_m->m[_32] = m1->m[_30] * m2->m[_02] + m1->m[_31] * m2->m[_12] + m1->m[_32] * m2->m[_22] + m1->m[_33] * m2->m[_32];
-  out_m->m[_33] = m1->m[_30] * m2->m[_03] + m1->m[_31] * m2->m[_13] + m1->m[_32] * m2->m[_23] + m1->m[_33] * m2->m[_33];
+  out_v->x = scalar_mul(mat4_row_dot(m, 0, v), inv_w);
+  out_v->y = scalar_mul(mat4_row_dot(m, 1, v), inv_w);
+  out_v->z = scalar_mul(mat4_row_dot(m, 2, v), inv_w);
 }
 
-void mat4_multiply_vec3(Vec3* out_v, const Mat4* m, const Vec3* v)
+void mat4_transform_points(Vec3* out_points, const Mat4* m, const Vec3* points, int count)
+{
+  const Scalar m00 = m->m[_00], m01 = m->m[_01], m02 = m->m[_02], m03 = m->m[_03];
+  const Scalar m10 = m->m[_10], m11 = m->m[_11], m12 = m->m[_12], m13 = m->m[_13];
+  const Scalar m20 = m->m[_20], m21 = m->m[_21], m22 = m->m[_22], m23 = m->m[_23];
+  const Scalar m30 = m->m[_30], m31 = m->m[_31], m32 = m->m[_32], m33 = m->m[_33];
+
+  for (int i = 0; i < count; ++i)
+  {
+    const Scalar x = points[i].x;
+    const Scalar y = points[i].y;
+    const Scalar z = points[i].z;
+    Scalar inv_w = scalar_div(SCALAR_ONE, scalar_narrow(
+      scalar_mul_wide(m30, x) + scalar_mul_wide(m31, y) + scalar_mul_wide(m32, z) + scalar_widen(m33)));
+
+    out_points[i].x = scalar_mul(scalar_narrow(
+      scalar_mul_wide(m00, x) + scalar_mul_wide(m01, y) + scalar_mul_wide(m02, z) + scalar_widen(m03)), inv_w);
+    out_points[i].y = scalar_mul(scalar_narrow(
+      scalar_mul_wide(m10, x) + scalar_mul_wide(m11, y) + scalar_mul_wide(m12, z) + scalar_widen(m13)), inv_w);
+    out_points[i].z = scalar_mul(scalar_narrow(
+      scalar_mul_wide(m20, x) + scalar_mul_wide(m21, y) + scalar_mul_wide(m22, z) + scalar_widen(m23)), inv_w);
+  }
+}
+
+bool mat4_is_affine(const Mat4* m)
 {
-  float inv_w = 1.0f / (m->m[_30] * v->x + m->m[_31] * v->y + m->m[_32] * v->z + m->m[_33]);
+  return m->m[_30] == 0 && m->m[_31] == 0 && m->m[_32] == 0 && m->m[_33] == SCALAR_ONE;
+}
+
+void mat4_transform_points_affine(Vec3* out_points, const Mat4* m, const Vec3* points, int count)
+{
+  const Scalar m00 = m->m[_00], m01 = m->m[_01], m02 = m->m[_02], m03 = m->m[_03];
+  const Scalar m10 = m->m[_10], m11 = m->m[_11], m12 = m->m[_12], m13 = m->m[_13];
+  const Scalar m20 = m->m[_20], m21 = m->m[_21], m22 = m->m[_22], m23 = m->m[_23];
+
+  for (int i = 0; i < count; ++i)
+  {
+    const Scalar x = points[i].x;
+    const Scalar y = points[i].y;
+    const Scalar z = points[i].z;
+
+    out_points[i].x = scalar_narrow(
+      scalar_mul_wide(m00, x) + scalar_mul_wide(m01, y) + scalar_mul_wide(m02, z) + scalar_widen(m03));
+    out_points[i].y = scalar_narrow(
+      scalar_mul_wide(m10, x) + scalar_mul_wide(m11, y) + scalar_mul_wide(m12, z) + scalar_widen(m13));
+    out_points[i].z = scalar_narrow(
+      scalar_mul_wide(m20, x) + scalar_mul_wide(m21, y) + scalar_mul_wide(m22, z) + scalar_widen(m23));
+  }
+}
+
+void mat4_translate_scale(Mat4* out_m, const Mat4* m, const Vec3* translate, Scalar scale)
+{
+  for (int i = 0; i < 12; ++i)
+  {
+    out_m->m[i] = scalar_mul(m->m[i], scale);
+  }
 
-  out_v->x = (m->m[_00] * v->x + m->m[_01] * v->y + m->m[_02] * v->z + m->m[_03]) * inv_w;
-  out_v->y = (m->m[_10] * v->x + m->m[_11] * v->y + m->m[_12] * v->z + m->m[_13]) * inv_w;
-  out_v->z = (m->m[_20] * v->x + m->m[_21] * v->y + m->m[_22] * v->z + m->m[_23]) * inv_w;
+  out_m->m[_03] = mat4_row_dot(m, 0, translate);
+  out_m->m[_13] = mat4_row_dot(m, 1, translate);
+  out_m->m[_23] = mat4_row_dot(m, 2, translate);
+  out_m->m[_33] = mat4_row_dot(m, 3, translate);
 }
 
 void mat4_translate(Mat4* m, const Vec3* translate)
 {
-  m->m[_00] = 1.0f; m->m[_01] = 0.0f; m->m[_02] = 0.0f; m->m[_03] = translate->x;
-  m->m[_10] = 0.0f; m->m[_11] = 1.0f; m->m[_12] = 0.0f; m->m[_13] = translate->y;
-  m->m[_20] = 0.0f; m->m[_21] = 0.0f; m->m[_22] = 1.0f; m->m[_23] = translate->z;
-  m->m[_30] = 0.0f; m->m[_31] = 0.0f; m->m[_32] = 0.0f; m->m[_33] = 1.0f;
+  m->m[_00] = SCALAR_ONE; m->m[_01] = 0; m->m[_02] = 0; m->m[_03] = translate->x;
+  m->m[_10] = 0; m->m[_11] = SCALAR_ONE; m->m[_12] = 0; m->m[_13] = translate->y;
+  m->m[_20] = 0; m->m[_21] = 0; m->m[_22] = SCALAR_ONE; m->m[_23] = translate->z;
+  m->m[_30] = 0; m->m[_31] = 0; m->m[_32] = 0; m->m[_33] = SCALAR_ONE;
 }
 
 void mat4_look_at_rh(Mat4* out_m, const Vec3* eye, const Vec3* at, const Vec3* up)
@@ -134,11 +248,11 @@ void mat4_look_at_rh(Mat4* out_m, const Vec3* eye, const Vec3* at, const Vec3* u
      s.x,  s.y,  s.z,    0,
      u.x,  u.y,  u.z,    0,
     -f.x, -f.y, -f.z,    0,
-       0,    0,    0,    1);
+       0,    0,    0,    SCALAR_ONE);
 
   Mat4 t2;
   Vec3 neg_eye;
-  vec3_multiply(&neg_eye, eye, -1);
+  vec3_multiply(&neg_eye, eye, -SCALAR_ONE);
   mat4_translate(&t2, &neg_eye);
 
   mat4_multiply(out_m, &t1, &t2);
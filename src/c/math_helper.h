@@ -1,33 +1,178 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
+//==============================================================================
+// scalar type
+//
+// Aplite, diorite and flint have no FPU, so they use Q16.16 fixed point and
+// every other platform keeps float. Define MATH_FIXED_POINT to force the fixed
+// point backend elsewhere (e.g. for host accuracy checks).
+
+#if defined(PBL_PLATFORM_APLITE) || defined(PBL_PLATFORM_DIORITE) || defined(PBL_PLATFORM_FLINT)
+#ifndef MATH_FIXED_POINT
+#define MATH_FIXED_POINT
+#endif
+#endif
+
+#ifdef MATH_FIXED_POINT
+
+typedef int32_t Scalar;
+
+#define SCALAR_FRACTION_BITS 16
+#define SCALAR_ONE ((Scalar)1 << SCALAR_FRACTION_BITS)
+#define SCALAR_EPSILON ((Scalar)1)
+
+// Only for constants: runtime floats would go through soft-float again.
+#define SCALAR(value) ((Scalar)((value) * (float)SCALAR_ONE + ((value) >= 0 ? 0.5f : -0.5f)))
+
+static inline Scalar scalar_from_int(int value)
+{
+  return (Scalar)(value * SCALAR_ONE);
+}
+
+static inline Scalar scalar_from_float(float value)
+{
+  return SCALAR(value);
+}
+
+static inline Scalar scalar_from_fraction(int32_t numerator, int32_t denominator)
+{
+  return (Scalar)(((int64_t)numerator * SCALAR_ONE) / denominator);
+}
+
+static inline float scalar_to_float(Scalar value)
+{
+  return (float)value / SCALAR_ONE;
+}
+
+static inline Scalar scalar_mul(Scalar a, Scalar b)
+{
+  return (Scalar)(((int64_t)a * b) >> SCALAR_FRACTION_BITS);
+}
+
+static inline Scalar scalar_div(Scalar a, Scalar b)
+{
+  return (Scalar)(((int64_t)a * SCALAR_ONE) / b);
+}
+
+// Products summed at full width and narrowed once, for dot products.
+typedef int64_t ScalarWide;
+
+static inline ScalarWide scalar_mul_wide(Scalar a, Scalar b)
+{
+  return (ScalarWide)a * b;
+}
+
+static inline ScalarWide scalar_widen(Scalar value)
+{
+  return (ScalarWide)value * SCALAR_ONE;
+}
+
+static inline Scalar scalar_narrow(ScalarWide value)
+{
+  return (Scalar)(value >> SCALAR_FRACTION_BITS);
+}
+
+static inline int scalar_round_to_int(Scalar value)
+{
+  return value >= 0
+    ? (int)((value + SCALAR_ONE / 2) >> SCALAR_FRACTION_BITS)
+    : -(int)((-value + SCALAR_ONE / 2) >> SCALAR_FRACTION_BITS);
+}
+
+#else
+
+typedef float Scalar;
+
+#define SCALAR_ONE 1.0f
+#define SCALAR_EPSILON 1e-06f
+#define SCALAR(value) ((Scalar)(value))
+
+static inline Scalar scalar_from_int(int value)
+{
+  return (Scalar)value;
+}
+
+static inline Scalar scalar_from_float(float value)
+{
+  return value;
+}
+
+static inline Scalar scalar_from_fraction(int32_t numerator, int32_t denominator)
+{
+  return (Scalar)numerator / denominator;
+}
+
+static inline float scalar_to_float(Scalar value)
+{
+  return value;
+}
+
+static inline Scalar scalar_mul(Scalar a, Scalar b)
+{
+  return a * b;
+}
+
+static inline Scalar scalar_div(Scalar a, Scalar b)
+{
+  return a / b;
+}
+
+typedef float ScalarWide;
+
+static inline ScalarWide scalar_mul_wide(Scalar a, Scalar b)
+{
+  return a * b;
+}
+
+static inline ScalarWide scalar_widen(Scalar value)
+{
+  return value;
+}
+
+static inline Scalar scalar_narrow(ScalarWide value)
+{
+  return value;
+}
+
+static inline int scalar_round_to_int(Scalar value)
+{
+  return (int)(value + (value >= 0 ? 0.5f : -0.5f));
+}
+
+#endif
+
 //==============================================================================
-// sqrt implement from Quake 3
+// sqrt implement from Quake 3 (float), bitwise integer sqrt (fixed point)
 
 #define SQRT_MAGIC_F 0x5f3759df
 
 float q_sqrt(const float x);
+Scalar scalar_sqrt(const Scalar x);
 
 //==============================================================================
 
 typedef struct Vec3
 {
-  float x, y, z;
+  Scalar x, y, z;
 } Vec3;
 
 #define Vec3(x, y, z) ((Vec3){(x), (y), (z)})
 
 void vec3_plus(Vec3* out_v, const Vec3* v1, const Vec3* v2);
 void vec3_minus(Vec3* out_v, const Vec3* v1, const Vec3* v2);
-void vec3_multiply(Vec3* out_v, const Vec3* v1, float multiplier);
-float vec3_length(const Vec3* v);
-float vec3_normalize(Vec3* v);
+void vec3_multiply(Vec3* out_v, const Vec3* v1, Scalar multiplier);
+Scalar vec3_length(const Vec3* v);
+Scalar vec3_normalize(Vec3* v);
 void vec3_cross_product(Vec3* out_v, const Vec3* v1, const Vec3* v2);
 
 //==============================================================================
 
 typedef struct Mat4
 {
-  float m[16];
+  Scalar m[16];
 } Mat4;
 
 enum Mat4RowCol  // column-major
@@ -54,11 +199,17 @@ enum Mat4RowCol  // column-major
 };
 
 void mat4_set(Mat4* m,
-  float m00, float m01, float m02, float m03,
-  float m10, float m11, float m12, float m13,
-  float m20, float m21, float m22, float m23,
-  float m30, float m31, float m32, float m33);
+  Scalar m00, Scalar m01, Scalar m02, Scalar m03,
+  Scalar m10, Scalar m11, Scalar m12, Scalar m13,
+  Scalar m20, Scalar m21, Scalar m22, Scalar m23,
+  Scalar m30, Scalar m31, Scalar m32, Scalar m33);
 void mat4_multiply(Mat4* out_m, const Mat4* m1, const Mat4* m2);
 void mat4_multiply_vec3(Vec3* out_v, const Mat4* m, const Vec3* v);
+void mat4_transform_points(Vec3* out_points, const Mat4* m, const Vec3* points, int count);
+// Bottom row (0, 0, 0, 1): w is always 1 and the divide can be skipped.
+bool mat4_is_affine(const Mat4* m);
+void mat4_transform_points_affine(Vec3* out_points, const Mat4* m, const Vec3* points, int count);
+// out_m = m * translate(translate) * scale(scale)
+void mat4_translate_scale(Mat4* out_m, const Mat4* m, const Vec3* translate, Scalar scale);
 void mat4_translate(Mat4* m, const Vec3* translate);
 void mat4_look_at_rh(Mat4* out_m, const Vec3* eye, const Vec3* at, const Vec3* up);
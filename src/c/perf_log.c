@@ -0,0 +1,190 @@
+#include "perf_log.h"
+#include "app_settings.h"
+
+#define PERF_LOG_VERSION 2
+// main.c opens the outbox at 128 bytes: a one-tuple dictionary takes 8 of them
+#define PERF_LOG_MESSAGE_MAX_RECORDS ((128 - 8) / sizeof(PerfRecord))
+
+typedef struct PerfLogBlob
+{
+  uint8_t version;
+  // slots the next transition and launch records go to
+  uint8_t next;
+  uint8_t count;
+  uint8_t launch_next;
+  uint8_t launch_count;
+  uint8_t reserved[3];
+  PerfRecord records[PERF_LOG_CAPACITY];
+  PerfRecord launches[PERF_LOG_LAUNCH_CAPACITY];
+} PerfLogBlob;
+
+_Static_assert(sizeof(PerfRecord) == 8, "PerfRecord is 8 bytes on the wire");
+_Static_assert(sizeof(PerfLogBlob) <= PERSIST_DATA_MAX_LENGTH, "the perf log fits one persist key");
+_Static_assert(PERF_LOG_CAPACITY + PERF_LOG_LAUNCH_CAPACITY <= PERF_LOG_MESSAGE_MAX_RECORDS,
+  "every record fits one message");
+
+typedef struct PerfLogState
+{
+  PerfLogBlob blob;
+  bool dirty;
+  bool launch_pending;
+  uint32_t launch_ms;
+  uint32_t last_frame_ms;
+  uint32_t heap_high_water;
+} PerfLogState;
+
+static PerfLogState s_perf_log;
+
+static uint32_t now_ms(void)
+{
+  time_t seconds;
+  uint16_t ms;
+
+  time_ms(&seconds, &ms);
+  return (uint32_t)seconds * 1000 + ms;
+}
+
+static void load_blob(PerfLogBlob *blob)
+{
+  if (persist_get_size(PERSIST_KEY_PERF_LOG) != (int)sizeof(*blob) ||
+    persist_read_data(PERSIST_KEY_PERF_LOG, blob, sizeof(*blob)) != (int)sizeof(*blob) ||
+    blob->version != PERF_LOG_VERSION || blob->next >= PERF_LOG_CAPACITY || blob->count > PERF_LOG_CAPACITY ||
+    blob->launch_next >= PERF_LOG_LAUNCH_CAPACITY || blob->launch_count > PERF_LOG_LAUNCH_CAPACITY)
+  {
+    memset(blob, 0, sizeof(*blob));
+    blob->version = PERF_LOG_VERSION;
+  }
+}
+
+static void flush(void)
+{
+  if (s_perf_log.dirty)
+  {
+    persist_write_data(PERSIST_KEY_PERF_LOG, &s_perf_log.blob, sizeof(s_perf_log.blob));
+    s_perf_log.dirty = false;
+  }
+}
+
+static void sample_heap(void)
+{
+  const uint32_t heap_used = heap_bytes_used();
+
+  if (heap_used > s_perf_log.heap_high_water)
+  {
+    s_perf_log.heap_high_water = heap_used;
+  }
+}
+
+static void ring_append(PerfRecord *ring, uint8_t *next, uint8_t *count, int capacity, PerfRecord record)
+{
+  ring[*next] = record;
+  *next = (*next + 1) % capacity;
+  if (*count < capacity)
+  {
+    ++*count;
+  }
+}
+
+// Oldest first; returns how many were copied.
+static int ring_copy(PerfRecord *out_records, const PerfRecord *ring, int next, int count, int capacity)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    out_records[i] = ring[(next + capacity - count + i) % capacity];
+  }
+
+  return count;
+}
+
+static void append(PerfRecordKind kind, uint16_t frames, uint16_t time_ms)
+{
+  PerfLogBlob *blob = &s_perf_log.blob;
+  PerfRecord record;
+
+  sample_heap();
+  record = (PerfRecord) {
+    .kind = kind,
+    .frames = frames < UINT8_MAX ? frames : UINT8_MAX,
+    .time_ms = time_ms,
+    .heap_high_water = s_perf_log.heap_high_water,
+  };
+
+  if (kind == PERF_RECORD_LAUNCH)
+  {
+    ring_append(blob->launches, &blob->launch_next, &blob->launch_count, PERF_LOG_LAUNCH_CAPACITY, record);
+  }
+  else
+  {
+    ring_append(blob->records, &blob->next, &blob->count, PERF_LOG_CAPACITY, record);
+  }
+  s_perf_log.dirty = true;
+}
+
+static void send_records(void)
+{
+  const PerfLogBlob *blob = &s_perf_log.blob;
+  PerfRecord records[PERF_LOG_LAUNCH_CAPACITY + PERF_LOG_CAPACITY];
+  DictionaryIterator *iterator;
+  int count;
+
+  count = ring_copy(records, blob->launches, blob->launch_next, blob->launch_count, PERF_LOG_LAUNCH_CAPACITY);
+  count += ring_copy(&records[count], blob->records, blob->next, blob->count, PERF_LOG_CAPACITY);
+
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK)
+  {
+    return;
+  }
+  dict_write_data(iterator, MESSAGE_KEY_PERF_RECORDS, (const uint8_t *)records, count * sizeof(PerfRecord));
+  app_message_outbox_send();
+}
+
+void perf_log_init(void)
+{
+  s_perf_log.launch_ms = now_ms();
+  s_perf_log.launch_pending = true;
+  s_perf_log.last_frame_ms = 0;
+  s_perf_log.dirty = false;
+  s_perf_log.heap_high_water = 0;
+  load_blob(&s_perf_log.blob);
+}
+
+void perf_log_deinit(void)
+{
+  flush();
+}
+
+void perf_log_frame_drawn(void)
+{
+  s_perf_log.last_frame_ms = now_ms();
+  if (!s_perf_log.launch_pending)
+  {
+    return;
+  }
+
+  const uint32_t elapsed = s_perf_log.last_frame_ms - s_perf_log.launch_ms;
+
+  s_perf_log.launch_pending = false;
+  append(PERF_RECORD_LAUNCH, 0, elapsed < UINT16_MAX ? elapsed : UINT16_MAX);
+}
+
+uint32_t perf_log_get_last_frame_ms(void)
+{
+  return s_perf_log.last_frame_ms;
+}
+
+void perf_log_record_transition(uint16_t frames, uint16_t worst_frame_ms)
+{
+  append(PERF_RECORD_TRANSITION, frames, worst_frame_ms);
+}
+
+bool perf_log_apply_message(DictionaryIterator *iterator)
+{
+  if (dict_find(iterator, MESSAGE_KEY_PERF_REQUEST) == NULL)
+  {
+    return false;
+  }
+
+  flush();
+  send_records();
+  return true;
+}
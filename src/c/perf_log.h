@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// Compact records of how launches and camera transitions ran, kept in a ring
+// in persistent storage for the phone to read back. Records collect in RAM and
+// are written out on deinit and when the phone asks for them, not once a
+// minute, to spare the flash.
+
+#define PERF_LOG_CAPACITY 12
+// launches keep a ring of their own, so a long session of transitions does not
+// push them out
+#define PERF_LOG_LAUNCH_CAPACITY 2
+
+typedef enum PerfRecordKind
+{
+  PERF_RECORD_LAUNCH = 1,
+  PERF_RECORD_TRANSITION = 2,
+} PerfRecordKind;
+
+// Stored and sent as is: 8 bytes, little endian.
+typedef struct PerfRecord
+{
+  uint8_t kind;
+  // transition: frames the camera moved (saturates at 255); launch: 0
+  uint8_t frames;
+  // transition: worst redraw, from the camera update it followed to the end of
+  // the digit update procs; launch: cold start to the first digit drawn
+  uint16_t time_ms;
+  // highest heap_bytes_used() since launch, sampled as each record is written:
+  // a transition's while its animation is still allocated
+  uint32_t heap_high_water;
+} PerfRecord;
+
+// First thing at launch: the cold start clock starts here.
+void perf_log_init(void);
+void perf_log_deinit(void);
+// At the end of the digit update procs; the first call after perf_log_init
+// records the launch.
+void perf_log_frame_drawn(void);
+// time_ms clock, in ms, when perf_log_frame_drawn last ran; 0 before it has.
+uint32_t perf_log_get_last_frame_ms(void);
+void perf_log_record_transition(uint16_t frames, uint16_t worst_frame_ms);
+// Sends the launch records, then the transition records, each oldest first,
+// when the message asks for them; false otherwise.
+bool perf_log_apply_message(DictionaryIterator *iterator);
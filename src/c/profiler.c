@@ -0,0 +1,161 @@
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+typedef struct ProfilerState
+{
+  ProfileSink sink;
+  void *sink_context;
+  ProfileSummary summary;
+  // between profiler_transition_begin and profiler_transition_end
+  bool active;
+  bool frame_open;
+  // a layer update proc ran in the open frame
+  bool frame_drawn;
+  uint32_t frame_start_ms;
+  // end of the last timed section in the open frame
+  uint32_t frame_last_ms;
+} ProfilerState;
+
+static ProfilerState s_profiler;
+
+static uint32_t now_ms(void)
+{
+  time_t seconds;
+  uint16_t ms;
+
+  time_ms(&seconds, &ms);
+  return (uint32_t)seconds * 1000 + ms;
+}
+
+static void close_frame(void)
+{
+  ProfileSummary *summary = &s_profiler.summary;
+  const uint32_t elapsed = s_profiler.frame_last_ms - s_profiler.frame_start_ms;
+  const uint16_t frame_ms = elapsed < UINT16_MAX ? elapsed : UINT16_MAX;
+
+  // An update the redraw never followed, like the one anim_stopped replaces.
+  if (!s_profiler.frame_open || !s_profiler.frame_drawn)
+  {
+    s_profiler.frame_open = false;
+    return;
+  }
+
+  ++summary->frames;
+  summary->total_frame_ms += frame_ms;
+  summary->min_frame_ms = frame_ms < summary->min_frame_ms ? frame_ms : summary->min_frame_ms;
+  summary->max_frame_ms = frame_ms > summary->max_frame_ms ? frame_ms : summary->max_frame_ms;
+  if (frame_ms > summary->budget_ms)
+  {
+    ++summary->budget_misses;
+  }
+  s_profiler.frame_open = false;
+}
+
+static void log_summary(const ProfileSummary *summary, void *context)
+{
+  const uint32_t frames = summary->frames > 0 ? summary->frames : 1;
+
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "transition: %u frames, min/avg/max %u/%lu/%u ms, %u over %u ms",
+    summary->frames, summary->min_frame_ms, (unsigned long)(summary->total_frame_ms / frames),
+    summary->max_frame_ms, summary->budget_misses, summary->budget_ms);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "ms: anim %lu, update_proc %lu, fill %lu, lines %lu/%lu/%lu",
+    (unsigned long)summary->section_ms[PROFILE_SECTION_ANIM_UPDATE],
+    (unsigned long)summary->section_ms[PROFILE_SECTION_UPDATE_PROC],
+    (unsigned long)summary->section_ms[PROFILE_SECTION_FILL],
+    (unsigned long)summary->section_ms[PROFILE_SECTION_BACK_LINES],
+    (unsigned long)summary->section_ms[PROFILE_SECTION_SIDE_LINES],
+    (unsigned long)summary->section_ms[PROFILE_SECTION_FRONT_LINES]);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "per frame: %lu transforms, %lu fills, %lu lines, %lu stroke colors",
+    (unsigned long)(summary->counters[PROFILE_COUNTER_TRANSFORMS] / frames),
+    (unsigned long)(summary->counters[PROFILE_COUNTER_FILLS] / frames),
+    (unsigned long)(summary->counters[PROFILE_COUNTER_LINES] / frames),
+    (unsigned long)(summary->counters[PROFILE_COUNTER_STROKE_COLORS] / frames));
+}
+
+void profiler_set_sink(ProfileSink sink, void *context)
+{
+  s_profiler.sink = sink;
+  s_profiler.sink_context = context;
+}
+
+void profiler_transition_begin(uint16_t budget_ms)
+{
+  profiler_transition_end();
+
+  memset(&s_profiler.summary, 0, sizeof(s_profiler.summary));
+  s_profiler.summary.min_frame_ms = UINT16_MAX;
+  s_profiler.summary.budget_ms = budget_ms;
+  s_profiler.active = true;
+  s_profiler.frame_open = false;
+}
+
+void profiler_transition_end(void)
+{
+  if (!s_profiler.active)
+  {
+    return;
+  }
+
+  close_frame();
+  s_profiler.active = false;
+  if (s_profiler.summary.frames == 0)
+  {
+    s_profiler.summary.min_frame_ms = 0;
+  }
+
+  if (s_profiler.sink != NULL)
+  {
+    s_profiler.sink(&s_profiler.summary, s_profiler.sink_context);
+  }
+  else
+  {
+    log_summary(&s_profiler.summary, NULL);
+  }
+}
+
+void profiler_frame(void)
+{
+  if (!s_profiler.active)
+  {
+    return;
+  }
+
+  close_frame();
+  s_profiler.frame_open = true;
+  s_profiler.frame_drawn = false;
+  s_profiler.frame_start_ms = now_ms();
+  s_profiler.frame_last_ms = s_profiler.frame_start_ms;
+}
+
+void profiler_count(ProfileCounter counter, uint32_t amount)
+{
+  if (s_profiler.active)
+  {
+    s_profiler.summary.counters[counter] += amount;
+  }
+}
+
+ProfileScope profiler_scope_begin(ProfileSection section)
+{
+  return (ProfileScope) { .section = section, .start_ms = now_ms() };
+}
+
+void profiler_scope_end(ProfileScope *scope)
+{
+  const uint32_t now = now_ms();
+
+  if (!s_profiler.active)
+  {
+    return;
+  }
+
+  s_profiler.summary.section_ms[scope->section] += now - scope->start_ms;
+  if (s_profiler.frame_open)
+  {
+    s_profiler.frame_last_ms = now;
+    s_profiler.frame_drawn |= scope->section == PROFILE_SECTION_UPDATE_PROC;
+  }
+}
+
+#endif
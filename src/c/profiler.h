@@ -0,0 +1,87 @@
+#pragma once
+
+#include <pebble.h>
+
+//==============================================================================
+// Hot-path timers and counters, summarized per camera transition. Compiled in
+// with -DPROFILER_ENABLED (PROFILER=1 for pebble build and the host tools);
+// without it every PROFILE_* macro expands to nothing.
+//
+// A frame runs from PROFILE_FRAME() to the last timed section before the next
+// one, so it covers the camera update and the redraw it triggers. Timers read
+// time_ms: a section shorter than a millisecond reads 0 or 1 each time, but
+// the sums over a transition average out to its real cost.
+
+typedef enum ProfileSection
+{
+  PROFILE_SECTION_ANIM_UPDATE,
+  PROFILE_SECTION_UPDATE_PROC,
+  PROFILE_SECTION_FILL,
+  PROFILE_SECTION_BACK_LINES,
+  PROFILE_SECTION_SIDE_LINES,
+  PROFILE_SECTION_FRONT_LINES,
+  PROFILE_SECTION_COUNT,
+} ProfileSection;
+
+typedef enum ProfileCounter
+{
+  PROFILE_COUNTER_TRANSFORMS,
+  // polygons or spans
+  PROFILE_COUNTER_FILLS,
+  PROFILE_COUNTER_LINES,
+  PROFILE_COUNTER_STROKE_COLORS,
+  PROFILE_COUNTER_COUNT,
+} ProfileCounter;
+
+typedef struct ProfileSummary
+{
+  // frames that redrew something
+  uint16_t frames;
+  uint16_t min_frame_ms;
+  uint16_t max_frame_ms;
+  uint32_t total_frame_ms;
+  // frames longer than budget_ms, the frame interval the transition ran at
+  uint16_t budget_ms;
+  uint16_t budget_misses;
+  uint32_t section_ms[PROFILE_SECTION_COUNT];
+  uint32_t counters[PROFILE_COUNTER_COUNT];
+} ProfileSummary;
+
+typedef void (*ProfileSink)(const ProfileSummary *summary, void *context);
+
+#ifdef PROFILER_ENABLED
+
+typedef struct ProfileScope
+{
+  ProfileSection section;
+  uint32_t start_ms;
+} ProfileScope;
+
+// NULL logs each summary with APP_LOG.
+void profiler_set_sink(ProfileSink sink, void *context);
+void profiler_transition_begin(uint16_t budget_ms);
+void profiler_transition_end(void);
+void profiler_frame(void);
+void profiler_count(ProfileCounter counter, uint32_t amount);
+ProfileScope profiler_scope_begin(ProfileSection section);
+void profiler_scope_end(ProfileScope *scope);
+
+// Times the rest of the enclosing block; one per block.
+#define PROFILE_SCOPE(section) \
+  ProfileScope profile_scope __attribute__((cleanup(profiler_scope_end))) = profiler_scope_begin(section)
+#define PROFILE_COUNT(counter, amount) profiler_count((counter), (amount))
+#define PROFILE_FRAME() profiler_frame()
+#define PROFILE_TRANSITION_BEGIN(budget_ms) profiler_transition_begin(budget_ms)
+#define PROFILE_TRANSITION_END() profiler_transition_end()
+#define PROFILE_SET_SINK(sink, context) profiler_set_sink((sink), (context))
+
+#else
+
+#define PROFILE_SCOPE(section) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_TRANSITION_BEGIN(budget_ms) ((void)0)
+#define PROFILE_TRANSITION_END() ((void)0)
+#define PROFILE_SET_SINK(sink, context) ((void)0)
+
+#endif
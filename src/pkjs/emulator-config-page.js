@@ -231,6 +231,92 @@
     sync_visible_sections();
   }
 
+  // Records from src/pkjs/emulator-config.js: kind.frames.time_ms.heap_high_water, joined by '_'.
+  function parse_perf_records() {
+    return get_param('perf', '').split('_').filter(function(entry) {
+      return entry !== '';
+    }).map(function(entry) {
+      var fields = entry.split('.');
+
+      return {
+        kind: fields[0] === 'l' ? 'launch' : 'transition',
+        frames: parseInt(fields[1], 10) || 0,
+        time_ms: parseInt(fields[2], 10) || 0,
+        heap_high_water: parseInt(fields[3], 10) || 0
+      };
+    });
+  }
+
+  // bounds are the upper ends (exclusive) of every bucket but the last
+  function render_histogram(container_id, values, bounds) {
+    var container = document.getElementById(container_id);
+    var counts = bounds.map(function() {
+      return 0;
+    }).concat([0]);
+    var max_count;
+
+    values.forEach(function(value) {
+      var bucket = 0;
+
+      while (bucket < bounds.length && value >= bounds[bucket]) {
+        bucket += 1;
+      }
+      counts[bucket] += 1;
+    });
+    max_count = Math.max.apply(null, counts.concat([1]));
+
+    container.innerHTML = '';
+    counts.forEach(function(count, bucket) {
+      var row = document.createElement('div');
+      var label = document.createElement('span');
+      var bar = document.createElement('div');
+      var total = document.createElement('span');
+
+      label.textContent = bucket < bounds.length ?
+        '< ' + bounds[bucket] + ' ms' : '>= ' + bounds[bounds.length - 1] + ' ms';
+      bar.className = 'histogram-bar';
+      bar.style.width = (count * 100 / max_count) + '%';
+      total.textContent = count;
+      row.className = 'histogram-row';
+      row.appendChild(label);
+      row.appendChild(bar);
+      row.appendChild(total);
+      container.appendChild(row);
+    });
+  }
+
+  function render_perf() {
+    var records = parse_perf_records();
+    var transitions = records.filter(function(record) {
+      return record.kind === 'transition';
+    });
+    var launches = records.filter(function(record) {
+      return record.kind === 'launch';
+    });
+    var frames = transitions.reduce(function(sum, record) {
+      return sum + record.frames;
+    }, 0);
+    var heap = records.reduce(function(max, record) {
+      return Math.max(max, record.heap_high_water);
+    }, 0);
+
+    if (records.length === 0) {
+      return;
+    }
+
+    document.getElementById('perf-card').className = 'card';
+    document.getElementById('perf-watch').textContent = get_param('perfWatch', '');
+    render_histogram('perf-frame-histogram', transitions.map(function(record) {
+      return record.time_ms;
+    }), [10, 20, 34, 67]);
+    render_histogram('perf-launch-histogram', launches.map(function(record) {
+      return record.time_ms;
+    }), [250, 500, 1000, 2000]);
+    document.getElementById('perf-summary').textContent =
+      (transitions.length > 0 ? Math.round(frames / transitions.length) + ' frames per transition, ' : '') +
+      'heap high-water ' + heap + ' bytes';
+  }
+
   document.getElementById('slow').checked = get_param('slow', '0') === '1';
   current_bg = round_to_palette(normalize_hex('bg', '000000'));
   current_face = round_to_palette(normalize_hex('face', 'ffaa00'));
@@ -246,6 +332,7 @@
   document.getElementById('split-line-colors').addEventListener('change', repaint);
   document.getElementById('randomize-colors').addEventListener('click', randomize_colors);
   repaint();
+  render_perf();
 
   document.getElementById('save').addEventListener('click', function() {
     var result = {
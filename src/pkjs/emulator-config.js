@@ -5,7 +5,14 @@ function encode_value(value, fallback) {
   return encodeURIComponent(value !== undefined ? value : fallback);
 }
 
-module.exports = function build_emulator_config_url(settings, palette_mode) {
+// kind (l / t), frames, time_ms and heap_high_water per record, joined by '_'.
+function encode_perf_records(records) {
+  return (records || []).map(function(record) {
+    return [record.kind === 'launch' ? 'l' : 't', record.frames, record.time_ms, record.heap_high_water].join('.');
+  }).join('_');
+}
+
+module.exports = function build_emulator_config_url(settings, palette_mode, perf_log) {
   var fallback_settings = defaultSettings[palette_mode] || defaultSettings.color;
 
   return 'data:text/html;charset=utf-8,' + encodeURIComponent(template) +
@@ -18,5 +25,7 @@ module.exports = function build_emulator_config_url(settings, palette_mode) {
     '&splitLine=' + encode_value(settings.SETTING_SPLIT_LINE_COLORS, fallback_settings.SETTING_SPLIT_LINE_COLORS ? 1 : 0) +
     '&backLine=' + encode_value(settings.SETTING_BACK_LINE_COLOR, fallback_settings.SETTING_BACK_LINE_COLOR) +
     '&sideLine=' + encode_value(settings.SETTING_SIDE_LINE_COLOR, fallback_settings.SETTING_SIDE_LINE_COLOR) +
-    '&palette=' + encode_value(palette_mode, 'color');
+    '&palette=' + encode_value(palette_mode, 'color') +
+    '&perf=' + encode_value(encode_perf_records(perf_log && perf_log.records), '') +
+    '&perfWatch=' + encode_value(perf_log && perf_log.watch, '');
 };
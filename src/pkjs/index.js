@@ -6,6 +6,26 @@ var buildEmulatorConfigUrl = require('./emulator-config');
 
 var clay = new Clay(clayConfig, customClay, { autoHandleEvents: false });
 var current_config_mode = 'clay';
+var PERF_REQUEST_TIMEOUT_MS = 2000;
+var PERF_RECORD_SIZE = 8;
+var pending_perf_callback = null;
+var SEND_RETRY_BASE_MS = 500;
+var SEND_RETRY_MAX_MS = 8000;
+var SEND_MAX_ATTEMPTS = 6;
+var SETTINGS_DELTA_VERSION = 2;
+// SettingsDeltaField in src/c/app_settings.c
+var SETTINGS_DELTA_FLAGS = 1 << 0;
+var SETTINGS_DELTA_COLORS = [
+  'SETTING_BG_COLOR',
+  'SETTING_FACE_COLOR',
+  'SETTING_LINE_COLOR',
+  'SETTING_BACK_LINE_COLOR',
+  'SETTING_SIDE_LINE_COLOR'
+];
+var outbox = [];
+var outbox_busy = false;
+var desired_settings = null;
+var settings_queued = false;
 var MESSAGE_KEYS = {
   SETTING_SLOW_VERSION: 0,
   SETTING_BG_COLOR: 1,
@@ -15,7 +35,11 @@ var MESSAGE_KEYS = {
   SETTING_LINE_MIX_WITH_BACKGROUND: 5,
   SETTING_SPLIT_LINE_COLORS: 6,
   SETTING_BACK_LINE_COLOR: 7,
-  SETTING_SIDE_LINE_COLOR: 8
+  SETTING_SIDE_LINE_COLOR: 8,
+  PERF_REQUEST: 9,
+  PERF_RECORDS: 10,
+  SETTINGS_DELTA: 11,
+  SETTINGS_CHECKSUM: 12
 };
 
 function get_platform_palette_mode() {
@@ -158,6 +182,262 @@ function save_settings(settings) {
   localStorage.setItem('fez-settings', JSON.stringify(settings));
 }
 
+// The settings the watch last acknowledged; deltas are taken against them.
+// Kept across sessions, and cleared when the watch nacks a delta or reports
+// other settings than these.
+function load_acked_settings() {
+  try {
+    return JSON.parse(localStorage.getItem('fez-acked-settings'));
+  } catch (err) {
+    return null;
+  }
+}
+
+function save_acked_settings(settings) {
+  localStorage.setItem('fez-acked-settings', JSON.stringify(settings));
+}
+
+function clear_acked_settings() {
+  localStorage.removeItem('fez-acked-settings');
+}
+
+//==============================================================================
+// outbox
+
+// One message in flight at a time. A nack retries the same entry with
+// exponential backoff; an entry is dropped after SEND_MAX_ATTEMPTS.
+// entry.build() returns the payload at send time, or null when there is
+// nothing left to send.
+function enqueue_message(entry) {
+  entry.attempts = 0;
+  outbox.push(entry);
+  send_next_message();
+}
+
+function finish_message(entry) {
+  outbox.shift();
+  outbox_busy = false;
+  if (entry.done) {
+    entry.done();
+  }
+  send_next_message();
+}
+
+function send_next_message() {
+  var entry = outbox[0];
+  var payload;
+
+  if (outbox_busy || !entry) {
+    return;
+  }
+
+  payload = entry.build();
+  if (payload === null) {
+    finish_message(entry);
+    return;
+  }
+
+  outbox_busy = true;
+  entry.attempts += 1;
+  Pebble.sendAppMessage(payload.message, function() {
+    if (entry.acked) {
+      entry.acked(payload);
+    }
+    finish_message(entry);
+  }, function(err) {
+    console.log('Failed to send ' + entry.name + ' (attempt ' + entry.attempts + ')');
+    console.log(JSON.stringify(err));
+    if (entry.nacked) {
+      entry.nacked();
+    }
+    if (entry.attempts >= SEND_MAX_ATTEMPTS) {
+      finish_message(entry);
+      return;
+    }
+
+    setTimeout(function() {
+      outbox_busy = false;
+      send_next_message();
+    }, Math.min(SEND_RETRY_BASE_MS * Math.pow(2, entry.attempts - 1), SEND_RETRY_MAX_MS));
+  });
+}
+
+//==============================================================================
+// settings delta
+
+function settings_flags(settings) {
+  return (settings.SETTING_SLOW_VERSION ? 1 : 0) |
+    (settings.SETTING_FACE_MIX_WITH_BACKGROUND ? 2 : 0) |
+    (settings.SETTING_LINE_MIX_WITH_BACKGROUND ? 4 : 0) |
+    (settings.SETTING_SPLIT_LINE_COLORS ? 8 : 0);
+}
+
+// The field mask and bytes for the fields of settings that differ from acked
+// (all of them without acked): flags, then 3 bytes per colour.
+function encode_settings_fields(settings, acked) {
+  var mask = 0;
+  var fields = [];
+
+  if (!acked || settings_flags(settings) !== settings_flags(acked)) {
+    mask |= SETTINGS_DELTA_FLAGS;
+    fields.push(settings_flags(settings));
+  }
+
+  SETTINGS_DELTA_COLORS.forEach(function(key, i) {
+    var color = settings[key];
+
+    if (!acked || color !== acked[key]) {
+      mask |= SETTINGS_DELTA_FLAGS << (i + 1);
+      fields.push((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+    }
+  });
+
+  return { mask: mask, fields: fields };
+}
+
+// Fletcher-16 of every field, as app_settings_checksum() on the watch.
+function settings_checksum(settings) {
+  var fields = encode_settings_fields(settings, null).fields;
+  var sum1 = 0;
+  var sum2 = 0;
+
+  fields.forEach(function(byte) {
+    sum1 = (sum1 + byte) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  });
+
+  return (sum2 << 8) | sum1;
+}
+
+// SETTINGS_DELTA bytes: version, the checksum of acked (the watch drops the
+// delta when it holds other settings), field mask, then the fields. null when
+// nothing differs, unless check asks for an empty delta that only has the
+// watch compare checksums.
+function encode_settings_delta(settings, acked, check) {
+  var encoded = encode_settings_fields(settings, acked);
+  var base = acked ? settings_checksum(acked) : 0;
+
+  if (encoded.mask === 0 && !check) {
+    return null;
+  }
+
+  return [SETTINGS_DELTA_VERSION, (base >> 8) & 0xFF, base & 0xFF, encoded.mask].concat(encoded.fields);
+}
+
+// Queues the settings once; whatever is newest when the message goes out is
+// diffed against the last acknowledged state, so quick successive saves
+// collapse into one delta. With check, the delta goes out even when empty.
+function send_settings(settings, check) {
+  desired_settings = clone_settings(settings);
+  if (settings_queued) {
+    return;
+  }
+
+  settings_queued = true;
+  enqueue_message({
+    name: 'settings',
+    build: function() {
+      var sent = desired_settings;
+      var delta = encode_settings_delta(sent, load_acked_settings(), check);
+
+      settings_queued = false;
+      if (delta === null) {
+        return null;
+      }
+
+      return { message: { [MESSAGE_KEYS.SETTINGS_DELTA]: delta }, settings: sent };
+    },
+    acked: function(payload) {
+      save_acked_settings(payload.settings);
+      console.log('Sent config data to Pebble');
+    },
+    // the retry carries every field
+    nacked: clear_acked_settings
+  });
+}
+
+// The watch dropped a delta taken against other settings than it holds.
+function resync_settings(watch_checksum) {
+  var acked = load_acked_settings();
+
+  if (acked && settings_checksum(acked) === watch_checksum) {
+    return;
+  }
+
+  clear_acked_settings();
+  send_settings(desired_settings || load_saved_settings());
+}
+
+function get_watch_label() {
+  var watch_info = typeof Pebble !== 'undefined' && Pebble.getActiveWatchInfo && Pebble.getActiveWatchInfo();
+  var firmware = watch_info && watch_info.firmware;
+
+  if (!watch_info) {
+    return '';
+  }
+
+  return watch_info.platform + (firmware ? ' ' + firmware.major + '.' + firmware.minor + '.' + firmware.patch : '');
+}
+
+// Records from src/c/perf_log.h, 8 little endian bytes each.
+function decode_perf_records(bytes) {
+  var records = [];
+
+  for (var i = 0; i + PERF_RECORD_SIZE <= bytes.length; i += PERF_RECORD_SIZE) {
+    records.push({
+      kind: bytes[i] === 1 ? 'launch' : 'transition',
+      frames: bytes[i + 1],
+      time_ms: bytes[i + 2] | (bytes[i + 3] << 8),
+      heap_high_water: (bytes[i + 4] | (bytes[i + 5] << 8) | (bytes[i + 6] << 16) | (bytes[i + 7] << 24)) >>> 0
+    });
+  }
+
+  return records;
+}
+
+function load_perf_log() {
+  var perf_log = null;
+
+  try {
+    perf_log = JSON.parse(localStorage.getItem('fez-perf'));
+  } catch (err) {
+    console.log('Failed to parse saved perf records', err);
+  }
+
+  return perf_log || { watch: get_watch_label(), records: [] };
+}
+
+function save_perf_log(perf_log) {
+  localStorage.setItem('fez-perf', JSON.stringify(perf_log));
+}
+
+function finish_perf_request(perf_log) {
+  var callback = pending_perf_callback;
+
+  pending_perf_callback = null;
+  if (callback) {
+    callback(perf_log);
+  }
+}
+
+// Asks the watch for its perf records; falls back to the last ones received
+// when it does not answer in time.
+function request_perf_records(callback) {
+  pending_perf_callback = callback;
+  setTimeout(function() {
+    if (pending_perf_callback === callback) {
+      finish_perf_request(load_perf_log());
+    }
+  }, PERF_REQUEST_TIMEOUT_MS);
+
+  enqueue_message({
+    name: 'perf request',
+    build: function() {
+      return { message: { [MESSAGE_KEYS.PERF_REQUEST]: 1 } };
+    }
+  });
+}
+
 function normalize_clay_settings(response) {
   var palette_mode = get_platform_palette_mode();
   var settings = clay.getSettings(response, false);
@@ -192,6 +472,17 @@ function normalize_emulator_settings(response) {
   };
 }
 
+// The app may have been reinstalled or the phone paired with another watch
+// since the acked settings were sent. An empty delta against them has the
+// watch report its checksum when it holds other settings.
+Pebble.addEventListener('ready', function() {
+  var saved_settings = load_saved_settings();
+
+  if (Object.keys(saved_settings).length > 0) {
+    send_settings(saved_settings, true);
+  }
+});
+
 Pebble.addEventListener('showConfiguration', function() {
   var palette_mode = get_platform_palette_mode();
   var fallback_settings = get_default_settings(palette_mode);
@@ -200,15 +491,40 @@ Pebble.addEventListener('showConfiguration', function() {
 
   if (is_emulator()) {
     current_config_mode = 'emulator';
-    Pebble.openURL(buildEmulatorConfigUrl(initial_settings, palette_mode));
+    request_perf_records(function(perf_log) {
+      Pebble.openURL(buildEmulatorConfigUrl(initial_settings, palette_mode, perf_log));
+    });
     return;
   }
 
+  // Clay has no telemetry view; the records are only kept for the next emulator page.
   current_config_mode = 'clay';
+  request_perf_records(function() {});
   clay.setSettings(initial_settings);
   Pebble.openURL(clay.generateUrl());
 });
 
+Pebble.addEventListener('appmessage', function(e) {
+  var payload = (e && e.payload) || {};
+  var bytes = payload.PERF_RECORDS !== undefined ? payload.PERF_RECORDS : payload[MESSAGE_KEYS.PERF_RECORDS];
+  var checksum = payload.SETTINGS_CHECKSUM !== undefined ?
+    payload.SETTINGS_CHECKSUM :
+    payload[MESSAGE_KEYS.SETTINGS_CHECKSUM];
+  var perf_log;
+
+  if (checksum !== undefined) {
+    resync_settings(checksum);
+  }
+
+  if (bytes === undefined) {
+    return;
+  }
+
+  perf_log = { watch: get_watch_label(), records: decode_perf_records(bytes) };
+  save_perf_log(perf_log);
+  finish_perf_request(perf_log);
+});
+
 Pebble.addEventListener('webviewclosed', function(e) {
   var settings;
 
@@ -228,20 +544,5 @@ Pebble.addEventListener('webviewclosed', function(e) {
   settings = sanitize_settings(settings, null, get_platform_palette_mode());
   save_settings(settings);
 
-  Pebble.sendAppMessage({
-    [MESSAGE_KEYS.SETTING_SLOW_VERSION]: settings.SETTING_SLOW_VERSION,
-    [MESSAGE_KEYS.SETTING_BG_COLOR]: settings.SETTING_BG_COLOR,
-    [MESSAGE_KEYS.SETTING_FACE_COLOR]: settings.SETTING_FACE_COLOR,
-    [MESSAGE_KEYS.SETTING_LINE_COLOR]: settings.SETTING_LINE_COLOR,
-    [MESSAGE_KEYS.SETTING_FACE_MIX_WITH_BACKGROUND]: settings.SETTING_FACE_MIX_WITH_BACKGROUND,
-    [MESSAGE_KEYS.SETTING_LINE_MIX_WITH_BACKGROUND]: settings.SETTING_LINE_MIX_WITH_BACKGROUND,
-    [MESSAGE_KEYS.SETTING_SPLIT_LINE_COLORS]: settings.SETTING_SPLIT_LINE_COLORS,
-    [MESSAGE_KEYS.SETTING_BACK_LINE_COLOR]: settings.SETTING_BACK_LINE_COLOR,
-    [MESSAGE_KEYS.SETTING_SIDE_LINE_COLOR]: settings.SETTING_SIDE_LINE_COLOR
-  }, function() {
-    console.log('Sent config data to Pebble');
-  }, function(err) {
-    console.log('Failed to send config data to Pebble');
-    console.log(JSON.stringify(err));
-  });
+  send_settings(settings);
 });